@@ -22,6 +22,10 @@ void clear_pendsv();
 int get_svc_status();
 void set_svc_status(int status);
 void set_enable_memfault();
+void enable_cycle_counter();
+
+/** @brief DWT cycle count register, counts core clock cycles once enabled */
+#define DWT_CYCCNT ((volatile uint32_t *) 0xE0001004)
 
 /** @brief set breakpoint to current instruction */
 intrinsic void breakpoint(){
@@ -67,6 +71,18 @@ intrinsic uint32_t load_exclusive(uint32_t *addr) {
     return(result);
 }
 
+/** @brief wrapper for asm clz (count leading zeros), returns 32 for 0 */
+intrinsic uint32_t count_leading_zeros(uint32_t val) {
+    uint32_t result;
+    __asm volatile("clz %0, %1" : "=r" (result) : "r" (val));
+    return(result);
+}
+
+/** @brief read the DWT cycle counter, see enable_cycle_counter() */
+intrinsic uint32_t get_cycle_count() {
+    return *DWT_CYCCNT;
+}
+
 /** @brief saves interrupt enabled state and disables interrupts */
 intrinsic int save_interrupt_state_and_disable() {
     int result;
@@ -0,0 +1,50 @@
+/** @file   kernel_config.h
+ *
+ *  @brief  build time sizes of the kernel thread and mutex pools
+ *
+ *  Every value can also be overridden from the command line, for example
+ *  DEFINE_MACROS += -DMAX_THREADS=64 in the Makefile.
+**/
+
+#ifndef _KERNEL_CONFIG_H_
+#define _KERNEL_CONFIG_H_
+
+/** @brief number of user threads, the TCB pool also holds the main and idle threads */
+#ifndef MAX_THREADS
+#define MAX_THREADS 14
+#endif
+
+/** @brief number of mutexes in the kernel mutex pool */
+#ifndef MAX_MUTEXES
+#define MAX_MUTEXES 32
+#endif
+
+/** @brief number of counting semaphores in the kernel semaphore pool */
+#ifndef MAX_SEMAPHORES
+#define MAX_SEMAPHORES 16
+#endif
+
+/** @brief number of event flag groups in the kernel event pool */
+#ifndef MAX_EVENT_GROUPS
+#define MAX_EVENT_GROUPS 8
+#endif
+
+/** @brief number of message queues in the kernel message queue pool */
+#ifndef MAX_MSG_QUEUES
+#define MAX_MSG_QUEUES 8
+#endif
+
+/** @brief number of thread priorities, 0 being highest, must be a multiple of 32 up to 256 */
+#ifndef MAX_PRIO_LEVELS
+#define MAX_PRIO_LEVELS 32
+#endif
+
+#if (MAX_PRIO_LEVELS % 32 != 0) || (MAX_PRIO_LEVELS > 256)
+#error "MAX_PRIO_LEVELS must be a multiple of 32 up to 256, priorities are 8 bit"
+#endif
+
+#if (MAX_THREADS < 1) || (MAX_THREADS > 253)
+#error "MAX_THREADS must be between 1 and 253"
+#endif
+
+#endif /* _KERNEL_CONFIG_H_ */
@@ -59,6 +59,25 @@ void mm_region_disable(uint32_t region_number);
 
 int mm_region_enable(uint32_t region_number, void *base_address, uint8_t size_log2, int execute, int user_write_access);
 
+/**
+ * 
+ * @brief Same as mm_region_enable, with some of the eight equal sub-regions disabled so that
+ * a stack only has to be rounded up to an eighth of its region. Accesses to a disabled
+ * sub-region fall through to the other regions.
+ * 
+ * @param[in] number of the region to be enabled
+ * @param[in] pointer to the base address of the region
+ * @param[in] log (base 2) of the size of that region, at least 8 if any sub-region is disabled
+ * @param[in] sub-region disable bits, bit 0 disables the lowest eighth
+ * @param[in] execute bit to indicate if the region is executable or not
+ * @param[in] indication if the region is writeable by the user or not
+ * 
+ * @return 0 on success and -1 on failure
+ * 
+ **/
+
+int mm_region_enable_srd(uint32_t region_number, void *base_address, uint8_t size_log2, uint8_t srd, int execute, int user_write_access);
+
 /**
  * 
  * @brief This function performs the necessary handshaking which is needed to initialse and enable
@@ -0,0 +1,96 @@
+/** @file   probe.h
+ *
+ *  @brief  cycle counting probes around the kernel's exception handlers
+ *
+ *  A probe point reads the DWT cycle counter on entry and adds the cycles
+ *  to its probe's accumulator on exit. Times are inclusive, a handler
+ *  preempted by a higher priority exception is charged for it too. Probes
+ *  only exist in PROFILE builds (make PROFILE=1), otherwise probe_enter()
+ *  and probe_exit() compile to nothing.
+**/
+
+#ifndef _PROBE_H_
+#define _PROBE_H_
+
+#include <unistd.h>
+#include <stdint.h>
+#include <arm.h>
+
+/** @brief probe ids, also the index into the stats copied by sys_probe_dump() */
+//@{
+#define PROBE_SVC     0 /** svc_c_handler, syscalls which switched threads are only counted in blocked */
+#define PROBE_PENDSV  1 /** pendsv_c_handler */
+#define PROBE_SYSTICK 2 /** systick_c_handler */
+#define PROBE_SAADC   3 /** SAADC_IRQHandler */
+#define PROBE_GPIOTE  4 /** GPIOTE_IRQHandler */
+#define NUM_PROBES    5
+//@}
+
+/** @brief sys_probe_dump flags */
+//@{
+#define PROBE_DUMP_PRINT (1 << 0) /** printk every probe */
+#define PROBE_DUMP_RESET (1 << 1) /** zero the accumulators after the dump */
+//@}
+
+/**
+ * @brief      Accumulated cycles of one probe, same layout as the user
+ *             probe_stats_t.
+ */
+typedef struct {
+  uint64_t total; // cycles of all counted exits /
+  uint32_t count; // counted exits /
+  uint32_t min; // fewest cycles of an exit, UINT32_MAX before the first /
+  uint32_t max; // most cycles of an exit /
+  uint32_t blocked; // exits not counted because the thread was switched out /
+} probe_stats_t;
+
+#ifdef PROFILE
+
+/** @brief context switches so far, see probe_switched() */
+extern volatile uint32_t probe_switch_count;
+
+/** @brief start of a probe point, pass the result to probe_exit() */
+__attribute__((always_inline)) static inline uint32_t probe_enter() {
+    return get_cycle_count();
+}
+
+/** @brief number of context switches so far, to pass to probe_exit_thread() */
+__attribute__((always_inline)) static inline uint32_t probe_switches() {
+    return probe_switch_count;
+}
+
+/** @brief called by the PendSV for every switch to another thread */
+__attribute__((always_inline)) static inline void probe_switched() {
+    probe_switch_count++;
+}
+
+void probe_exit(uint32_t probe, uint32_t start);
+void probe_exit_thread(uint32_t probe, uint32_t start, uint32_t switches);
+
+#else
+
+__attribute__((always_inline)) static inline uint32_t probe_enter() { return 0; }
+__attribute__((always_inline)) static inline uint32_t probe_switches() { return 0; }
+__attribute__((always_inline)) static inline void probe_switched() {}
+__attribute__((always_inline)) static inline void probe_exit(uint32_t probe, uint32_t start) { (void)probe; (void)start; }
+__attribute__((always_inline)) static inline void probe_exit_thread(uint32_t probe, uint32_t start, uint32_t switches) { (void)probe; (void)start; (void)switches; }
+
+#endif /* PROFILE */
+
+/**
+ * @brief      printk the accumulators of every probe.
+ */
+void probe_print();
+
+/**
+ * @brief      Copies, prints and/or resets the probe accumulators.
+ *
+ * @param      stats  Where to copy the accumulators, or NULL.
+ * @param      n      Number of probe_stats_t which fit in stats.
+ * @param      flags  PROBE_DUMP_PRINT and/or PROBE_DUMP_RESET.
+ *
+ * @return     NUM_PROBES, -1 if the kernel was built without PROFILE.
+ */
+int sys_probe_dump(probe_stats_t* stats, uint32_t n, uint32_t flags);
+
+#endif /* _PROBE_H_ */
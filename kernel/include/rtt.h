@@ -13,10 +13,17 @@
 #include <unistd.h>
 #include <stdarg.h>
 
+// up buffer 1 carries the binary scheduler trace of TRACE builds, see trace.h
+#ifdef TRACE
+#define RTT_MAX_UP_BUFFERS		2
+#else
 #define RTT_MAX_UP_BUFFERS		1
+#endif
 #define RTT_MAX_DOWN_BUFFERS	1
+#define RTT_TRACE_BUFFER		1
 #define BUFFER_SIZE_UP			1024
 #define BUFFER_SIZE_DOWN		16
+#define BUFFER_SIZE_TRACE		4096
 
 #define MIN(a, b)  			(((a) < (b)) ? (a) : (b))
 #define MAX(a, b)  			(((a) > (b)) ? (a) : (b))
@@ -62,6 +69,7 @@ typedef struct {
 void rtt_init();
 
 uint32_t rtt_write(uint32_t buffer_index, const void* p_buffer, uint32_t num_bytes);
+uint32_t rtt_write_nonblocking(uint32_t buffer_index, const void* p_buffer, uint32_t num_bytes);
 uint32_t rtt_read(uint32_t buffer_index, void* p_buffer, uint32_t num_bytes);
 uint32_t rtt_has_data(uint32_t buffer_index);
 
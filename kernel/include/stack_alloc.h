@@ -0,0 +1,97 @@
+/** @file   stack_alloc.h
+ *
+ *  @brief  buddy allocator for the thread stack regions
+ *
+ *  Blocks are powers of two and naturally aligned, so every block can be
+ *  covered by a single MPU region. Stacks of 256 bytes and more only keep
+ *  the sub-regions they need out of their block, the rest of the block goes
+ *  back to the pool and the MPU region disables it with its SRD bits.
+**/
+
+#ifndef _STACK_ALLOC_H_
+#define _STACK_ALLOC_H_
+
+#include <unistd.h>
+
+/** @brief log2 of the smallest block, the smallest MPU region is 32 bytes */
+#define STACK_MIN_LOG2 5
+/** @brief log2 of the largest pool, the linker gives each stack region 32KB */
+#define STACK_POOL_MAX_LOG2 15
+/** @brief log2 of the smallest MPU region with sub-regions */
+#define STACK_SRD_MIN_LOG2 8
+/** @brief nodes of the complete binary tree over the largest pool, node 0 is unused */
+#define STACK_POOL_NODES (1 << (STACK_POOL_MAX_LOG2 - STACK_MIN_LOG2 + 1))
+
+/**
+ * 
+ * buddy allocator over one stack region, a set bit marks a free block which
+ * could not be merged with its buddy
+ * 
+ **/
+
+typedef struct stack_pool {
+    char* base; /** lowest address of the region */
+    uint32_t log2; /** log2 of the region size */
+    uint32_t free[STACK_POOL_NODES / 32]; /** free bit of every tree node, msb first */
+} stack_pool_t;
+
+/**
+ * 
+ * a stack carved out of a pool and the MPU region which covers it
+ * 
+ **/
+
+typedef struct stack_block {
+    void* start; /** lowest address of the stack */
+    void* end; /** one past the highest address of the stack */
+    uint8_t region_log2; /** log2 of the MPU region, based at start rounded down to its size */
+    uint8_t srd; /** MPU sub-region disable bits of that region */
+} stack_block_t;
+
+/**
+ * 
+ * @brief Makes the whole region a single free block.
+ * 
+ * @param[in] pool to initialise
+ * @param[in] lowest address of the region, aligned to its size
+ * @param[in] size of the region in bytes, a power of two up to 1 << STACK_POOL_MAX_LOG2
+ * 
+ * @return 0 on success and -1 on failure
+ * 
+ **/
+
+int stack_pool_init(stack_pool_t* pool, void* base, uint32_t size);
+
+/**
+ * 
+ * @brief Allocates a stack of at least size bytes. The stack sits at the top of a block
+ * rounded up to a power of two, below 256 bytes it uses the whole block, otherwise only
+ * the eighths of the block it needs and the bottom eighths are given back to the pool.
+ * 
+ * @param[in] pool to allocate from
+ * @param[in] stack size in bytes
+ * @param[out] the stack and its MPU region
+ * 
+ * @return 0 on success and -1 if the pool has no block large enough
+ * 
+ **/
+
+int stack_pool_alloc(stack_pool_t* pool, uint32_t size, stack_block_t* block);
+
+/**
+ * 
+ * @brief Gives a stack returned by stack_pool_alloc back to the pool, merging it with
+ * its free buddies. Only the pool bitmap is written, never the stack memory, so a
+ * thread may free the kernel stack it is still running on.
+ * 
+ * @param[in] pool the stack came from
+ * @param[in] lowest address of the stack
+ * @param[in] one past the highest address of the stack
+ * 
+ * @return none
+ * 
+ **/
+
+void stack_pool_free(stack_pool_t* pool, void* start, void* end);
+
+#endif /* _STACK_ALLOC_H_ */
@@ -77,4 +77,65 @@
 #define SEND_PKT 51
 #define RECV_PKT 52
 
+/** @brief SVC number for scheduler_start_mode() */
+#define SVC_SCHD_START_MODE 53
+/** @brief SVC number for thread_init_policy() */
+#define SVC_THR_INIT_POLICY 54
+/** @brief SVC number for thread_create_attr() */
+#define SVC_THR_CREATE_ATTR 55
+/** @brief SVC number for thread_stats() */
+#define SVC_THR_STATS 56
+/** @brief SVC number for server_wait() */
+#define SVC_SERVER_WAIT 57
+/** @brief SVC number for server_post() */
+#define SVC_SERVER_POST 58
+/** @brief SVC number for sem_init() */
+#define SVC_SEM_INIT 59
+/** @brief SVC number for sem_wait() */
+#define SVC_SEM_WAIT 60
+/** @brief SVC number for sem_post() */
+#define SVC_SEM_POST 61
+/** @brief SVC number for event_init() */
+#define SVC_EVENT_INIT 62
+/** @brief SVC number for event_wait() */
+#define SVC_EVENT_WAIT 63
+/** @brief SVC number for event_set() */
+#define SVC_EVENT_SET 64
+/** @brief SVC number for event_clear() */
+#define SVC_EVENT_CLEAR 65
+/** @brief SVC number for msgq_init() */
+#define SVC_MSGQ_INIT 66
+/** @brief SVC number for msgq_send() */
+#define SVC_MSGQ_SEND 67
+/** @brief SVC number for msgq_recv() */
+#define SVC_MSGQ_RECV 68
+/** @brief SVC number for msgq_reserve() */
+#define SVC_MSGQ_RESERVE 69
+/** @brief SVC number for msgq_commit() */
+#define SVC_MSGQ_COMMIT 70
+/** @brief SVC number for msgq_acquire() */
+#define SVC_MSGQ_ACQUIRE 71
+/** @brief SVC number for msgq_release() */
+#define SVC_MSGQ_RELEASE 72
+/** @brief SVC number for sleep_ticks() */
+#define SVC_SLEEP_TICKS 73
+/** @brief SVC number for sleep_until() */
+#define SVC_SLEEP_UNTIL 74
+/** @brief SVC number for get_cycles() */
+#define SVC_CYCLES 75
+/** @brief SVC number for probe_dump() */
+#define SVC_PROBE_DUMP 76
+/** @brief SVC number for sched_table_set() */
+#define SVC_SCHED_TABLE_SET 77
+/** @brief SVC number for thread_overrun() */
+#define SVC_THR_OVERRUN 78
+/** @brief SVC number for thread_stack_usage() */
+#define SVC_THR_STACK_USAGE 79
+/** @brief SVC number for thread_join() */
+#define SVC_THR_JOIN 80
+/** @brief SVC number for thread_kill_tid() */
+#define SVC_THR_KILL_TID 81
+/** @brief SVC number for thread_exit() */
+#define SVC_THR_EXIT 82
+
 #endif /* _SVC_NUM_H_ */
\ No newline at end of file
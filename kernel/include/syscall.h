@@ -10,6 +10,8 @@
 #ifndef _SYSCALL_H_
 #define _SYSCALL_H_
 
+#include <stdint.h>
+
 void* sys_sbrk(int incr);
 
 int sys_write(int file, char* ptr, int len);
@@ -18,4 +20,6 @@ int sys_read(int file, char* ptr, int len);
 
 void sys_exit(int status);
 
+void sys_delay_ms(uint32_t ms);
+
 #endif /* _SYSCALL_H_ */
@@ -0,0 +1,120 @@
+/** @file   syscall_msgq.h
+ *
+ *  @brief  prototypes for system calls to support message queues
+**/
+
+#ifndef _SYSCALL_MSGQ_H_
+#define _SYSCALL_MSGQ_H_
+
+#include <unistd.h>
+#include <stdint.h>
+#include <syscall_thread.h>
+
+/** @brief most slots in a message queue, one bit of each slot state mask per slot */
+#define MSGQ_MAX_SLOTS 32
+
+/**
+ * @brief      A message queue of fixed size slots in a buffer supplied by
+ *             the user. A slot is free, reserved by a sender, ready (a
+ *             committed message) or held by a receiver. Slots are reserved
+ *             and received in ring order, so messages are received in the
+ *             order their slots were reserved.
+ */
+typedef struct kmsgq {
+  char* buf; // slot memory, slots * slot_size bytes /
+  uint32_t slot_size; // size of a message in bytes /
+  uint32_t slots; // number of slots /
+  uint32_t used; // slots which are not free /
+  uint32_t tail; // oldest slot which is not free /
+  uint32_t read; // next slot to receive /
+  uint32_t write; // next slot to reserve /
+  uint32_t reserved; // slots reserved by a sender and not committed yet /
+  uint32_t ready; // slots holding a message which was not received yet /
+  uint32_t held; // slots received and not released yet /
+  struct tcb* senders; // threads waiting for a free slot, highest priority first /
+  struct tcb* receivers; // threads waiting for a message, highest priority first /
+} kmsgq_t;
+
+/**
+ * @brief      Creates a message queue over a user buffer.
+ *
+ * @param      buf        Slot memory, slots * slot_size bytes, must stay
+ *                        valid and accessible to every thread using the queue.
+ * @param      slot_size  Size of a message in bytes.
+ * @param      slots      Number of slots, at most MSGQ_MAX_SLOTS.
+ *
+ * @return     A pointer to the queue, NULL if the pool is exhausted or the
+ *             arguments are bad.
+ */
+kmsgq_t* sys_msgq_init(void* buf, uint32_t slot_size, uint32_t slots);
+
+/**
+ * @brief      Zero copy send, reserves the next slot, blocking while the
+ *             queue is full. The sender fills it in place and commits it.
+ *
+ * @param[in]  q        The queue to act on.
+ * @param[in]  timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no limit.
+ *
+ * @return     Pointer to the slot, NULL on timeout or a bad queue.
+ */
+void* sys_msgq_reserve(kmsgq_t* q, uint32_t timeout);
+
+/**
+ * @brief      Zero copy send, makes a reserved slot available to receivers.
+ *             Never blocks, so it may be called from interrupt handlers.
+ *
+ * @param[in]  q     The queue to act on.
+ * @param[in]  slot  Slot returned by sys_msgq_reserve.
+ *
+ * @return     0 on success, -1 if slot is not a reserved slot of q.
+ */
+int sys_msgq_commit(kmsgq_t* q, void* slot);
+
+/**
+ * @brief      Zero copy receive, takes the oldest message, blocking while
+ *             the queue is empty. The receiver reads it in place and
+ *             releases it.
+ *
+ * @param[in]  q        The queue to act on.
+ * @param[in]  timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no limit.
+ *
+ * @return     Pointer to the slot, NULL on timeout or a bad queue.
+ */
+void* sys_msgq_acquire(kmsgq_t* q, uint32_t timeout);
+
+/**
+ * @brief      Zero copy receive, frees a slot returned by sys_msgq_acquire.
+ *             Never blocks, so it may be called from interrupt handlers.
+ *
+ * @param[in]  q     The queue to act on.
+ * @param[in]  slot  Slot returned by sys_msgq_acquire.
+ *
+ * @return     0 on success, -1 if slot is not a received slot of q.
+ */
+int sys_msgq_release(kmsgq_t* q, void* slot);
+
+/**
+ * @brief      Copies slot_size bytes from msg into the queue, blocking while
+ *             the queue is full.
+ *
+ * @param[in]  q        The queue to act on.
+ * @param[in]  msg      The message.
+ * @param[in]  timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no limit.
+ *
+ * @return     0 on success, -1 on timeout or a bad queue.
+ */
+int sys_msgq_send(kmsgq_t* q, const void* msg, uint32_t timeout);
+
+/**
+ * @brief      Copies the oldest message out of the queue into msg, blocking
+ *             while the queue is empty.
+ *
+ * @param[in]  q        The queue to act on.
+ * @param[out] msg      Buffer of at least slot_size bytes.
+ * @param[in]  timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no limit.
+ *
+ * @return     0 on success, -1 on timeout or a bad queue.
+ */
+int sys_msgq_recv(kmsgq_t* q, void* msg, uint32_t timeout);
+
+#endif /* _SYSCALL_MSGQ_H_ */
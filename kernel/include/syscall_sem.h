@@ -0,0 +1,113 @@
+/** @file   syscall_sem.h
+ *
+ *  @brief  prototypes for system calls to support counting semaphores and
+ *          event flag groups
+**/
+
+#ifndef _SYSCALL_SEM_H_
+#define _SYSCALL_SEM_H_
+
+#include <unistd.h>
+#include <stdint.h>
+#include <syscall_thread.h>
+
+/** @brief event wait options */
+//@{
+#define EVENT_WAIT_ANY   (0)      /** wake when any of the flags is set */
+#define EVENT_WAIT_ALL   (1 << 0) /** wake when all of the flags are set */
+#define EVENT_WAIT_CLEAR (1 << 1) /** clear the flags which woke the waiter */
+//@}
+
+/**
+ * @brief      A counting semaphore. A post with waiters hands the count
+ *             directly to the highest priority waiter.
+ */
+typedef struct ksem {
+  volatile uint32_t count; // number of available units /
+  uint32_t max; // count saturates at max, a post beyond it fails /
+  struct tcb* waiters; // threads waiting for a unit, highest priority first /
+} ksem_t;
+
+/**
+ * @brief      A group of 32 event flags.
+ */
+typedef struct kevent {
+  volatile uint32_t flags; // currently set flags /
+  struct tcb* waiters; // threads waiting for flags, highest priority first /
+} kevent_t;
+
+/**
+ * @brief      Creates a counting semaphore.
+ *
+ * @param      count  Initial count.
+ * @param      max    Largest count, at least 1 and at least count.
+ *
+ * @return     A pointer to the semaphore, NULL if the pool is exhausted.
+ */
+ksem_t* sys_sem_init(uint32_t count, uint32_t max);
+
+/**
+ * @brief      Takes a unit of a semaphore, blocking while the count is 0.
+ *
+ * @param[in]  sem      The semaphore to act on.
+ * @param[in]  timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no limit.
+ *
+ * @return     0 once a unit was taken, -1 on timeout or a bad semaphore.
+ */
+int sys_sem_wait(ksem_t* sem, uint32_t timeout);
+
+/**
+ * @brief      Gives a unit back to a semaphore. Never blocks, so it may be
+ *             called from interrupt handlers as well as from an SVC.
+ *
+ * @param[in]  sem  The semaphore to act on.
+ *
+ * @return     0 on success, -1 if the count is already at its max or on a
+ *             bad semaphore.
+ */
+int sys_sem_post(ksem_t* sem);
+
+/**
+ * @brief      Creates an event flag group with every flag clear.
+ *
+ * @return     A pointer to the group, NULL if the pool is exhausted.
+ */
+kevent_t* sys_event_init();
+
+/**
+ * @brief      Waits for flags of an event group.
+ *
+ * @param[in]  event    The group to act on.
+ * @param[in]  mask     Flags to wait for, not 0.
+ * @param[in]  options  EVENT_WAIT_ANY or EVENT_WAIT_ALL, or'ed with
+ *                      EVENT_WAIT_CLEAR to consume the flags.
+ * @param[in]  timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no limit.
+ *
+ * @return     The flags of mask which were set when the wait ended, 0 on
+ *             timeout or a bad group.
+ */
+uint32_t sys_event_wait(kevent_t* event, uint32_t mask, uint32_t options, uint32_t timeout);
+
+/**
+ * @brief      Sets flags of an event group and wakes the waiters which are
+ *             satisfied, in priority order. Never blocks, so it may be called
+ *             from interrupt handlers as well as from an SVC.
+ *
+ * @param[in]  event  The group to act on.
+ * @param[in]  flags  Flags to set.
+ *
+ * @return     0 on success, -1 on a bad group.
+ */
+int sys_event_set(kevent_t* event, uint32_t flags);
+
+/**
+ * @brief      Clears flags of an event group.
+ *
+ * @param[in]  event  The group to act on.
+ * @param[in]  flags  Flags to clear.
+ *
+ * @return     0 on success, -1 on a bad group.
+ */
+int sys_event_clear(kevent_t* event, uint32_t flags);
+
+#endif /* _SYSCALL_SEM_H_ */
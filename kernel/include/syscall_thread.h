@@ -1,279 +1,747 @@
-/** @file   syscall_thread.h
- *
- *  @brief  system calls to support thread library for lab 4
- *  @note   Not for public release, do not share
- *
- *  @date   last modified 25 October 2022
- *  @author CMU 14-642
-**/
-
-#ifndef _SYSCALL_THREAD_H_
-#define _SYSCALL_THREAD_H_
-
-#include <unistd.h>
-#include<syscall_mutex.h>
-#include<mpu.h>
-
-/** @struct interrupt_stack_frame
- *  @brief stack frame upon interrupt/exception
- */
-typedef struct {
-    uint32_t r0;   /** @brief reg r0 value */
-    uint32_t r1;   /** @brief reg r1 value */
-    uint32_t r2;   /** @brief reg r2 value */
-    uint32_t r3;   /** @brief reg r3 value */
-    uint32_t r12;  /** @brief reg r12 value */
-    void* lr;   /** @brief reg lr value */
-    void* pc;   /** @brief reg pc value */
-    uint32_t xPSR; /** @brief reg xPSR value */
-} interrupt_stack_frame;
-
-/**
- * 
- * structure to store the global TCB
- * 
- **/
-
-typedef enum {
-    STOPPED = 0, /** task is in STOPPED state */
-    WAITING = 1, /** task is in WAITING state */
-    RUNNABLE = 2, /** task is in RUNNABLE state */
-    RUNNING = 3, /** task is in RUNNING state */
-    BLOCKED = 4 /** task is in BLOCKED state */
-} state_t;
-
-/**
- * 
- * this indicates a structure which stores all the necessary contents on the psp register.
- * Helpful in saving context 
- * 
- **/
-
-typedef struct msp_stack_frame {
-    interrupt_stack_frame* psp; /** interrupt stack frame of the psp */
-    uint32_t r4; /** r4 register on interrupt stack frame */
-    uint32_t r5; /** r5 register on interrupt stack frame */
-    uint32_t r6; /** r6 register on interrupt stack frame */
-    uint32_t r7; /** r7 register on interrupt stack frame */
-    uint32_t r8; /** r8 register on interrupt stack frame */
-    uint32_t r9; /** r9 register on interrupt stack frame */
-    uint32_t r10; /** r10 register on interrupt stack frame */
-    uint32_t r11; /** r11 register on interrupt stack frame */
-    void* lr; /** lr register on interrupt stack frame */
-} msp_stack_frame_t;
-
-/**
- * 
- * this indicates a structure which is used to store the context of the TCB for each thread
- * that is run on the system
- * 
- **/
-
-
-typedef struct tcb {
-    msp_stack_frame_t* msp; /** pointer to the msp stack frame */
-    uint32_t C; /** WCET of the the task */
-    uint32_t T; /** period of the task */
-    uint32_t prio; /** priority of the task */
-    void* fn; /** pointer to the function */
-    void* vargp; /** arguments to the thread */
-    uint32_t svc_status; /** svc status of the thread */
-    uint32_t running_time; /** current running time of the task */
-    state_t state; /** state of the task */
-    void* kernel_stack_start; /** starting of the kernel stack */
-    void* kernel_stack_end; /** ending of the kernel stack */
-    void* user_stack_start; /** starting of the user stack */
-    void* user_stack_end; /** ending of the kernel stack */
-    uint32_t execution_time; /** current execution time of the task */
-    uint8_t static_priority; /** static priority of the task */
-    uint8_t dynamic_priority; /** dynamic priority of the task */
-    uint32_t time_since_scheduler_start; /** cumulative time since the scheduler started */
-    struct tcb*  next; /** pointer to the nest tcb in the linked list */
-    struct kmutex_t* acquired_mutexes; /** linked list of acquired mutexes */
-} tcb_t;
-
-
-/** @brief initialize thread switching
- *  @note  must be called before creating threads or scheduling
- *
- *  @param max_threads      max number of threads to be created
- *  @param stack_size       stack size in words of all created stacks
- *  @param idle_fn          function pointer for idle thread, NULL for default
- *  @param mem_protect      mpu mode, either PER_THREAD or KERNEL_ONLY
- *  @param max_mutexes      max number of mutexes supported
- *
- *  @return     0 for success, -1 for failure
- */
-int sys_thread_init(uint32_t max_threads, uint32_t stack_sizes, void* idle_fn, mpu_mode mem_protect, uint32_t max_mutexes);
-
-/** @brief create a new thread as specified, if UB allows
- *
- *  @param fn       thread function pointer
- *  @param prio     thread priority, with 0 being highest
- *  @param C        execution time (scheduler ticks)
- *  @param T        task period (scheduler ticks)
- *  @param vargp    thread function argument
- *
- *  @return     0 for success, -1 for failure
- */
-int sys_thread_create(void* fn, uint32_t prio, uint32_t C, uint32_t T, void* vargp);
-
-/** @brief tell the kernel to start running threads using Systick
- *  @note  returns only after all threads complete or are killed
- *
- *  @param frequency  frequncy of context switches in Hz
- *
- *  @return     0 for success, -1 for failure
- */
-int sys_scheduler_start(uint32_t frequency);
-
-/** @brief get the current time in ticks */
-uint32_t sys_get_time();
-
-/** @brief get the dynamic priority of the running thread */
-uint32_t sys_get_priority();
-
-/** @brief get the total elapsed time for the running thread */
-uint32_t sys_thread_time();
-
-/** @brief deschedule thread and wait until next turn */
-void sys_wait_until_next_period();
-
-/** @brief kill the running thread
- *
- *  @note  locks if main or idle thread is running or thread holds a mutex
- *
- *  @return does not return
- */
-void sys_thread_kill();
-
-/**
- * 
- * @brief RMS scheduler which is used to find the highest priority task based on the time period
- * of each task.
- * 
- * @param[in] none
- * 
- * @return returns the ID of the thread 
- * 
- **/
-
-uint32_t RMS();
-
-/**
- * 
- * @brief Used to perform the UB test and outputs whether the task set is schedulable or not
- * 
- * @param[in] Number of threads in the system currently (includes the new thread to be scheduled)
- * @param[in] WCET of the task
- * @param[in] Time period of the task 
- * 
- * */
-
-
-int UB_test_RMS(uint32_t no_threads, uint32_t C, uint32_t T);
-
-/**
- * 
- * @brief This function is used to read the lux sensor. This is a system call which gets
- * called when the stub for the specific user function is pressed. 
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_read_lux();
-
-/**
- * 
- * @brief This function is used to read the microphone. This is a system call which gets
- * called when the stub for the specific user function is pressed. 
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_read_mic();
-
-/**
- * 
- * @brief This function is system call which is used to glow the led. This is called
- * via a stub from the user space function.
- * 
- * @param[in] If the user gives 0 then the leds turn off. Else, then remain on.
- * 
- * @return none
- * 
- */
-
-void sys_glow_led(int on);
-
-/**
- * 
- * @brief This function is used to move the car forward. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_move_forward(void);
-
-/**
- * 
- * @brief This function is used to move the car backward. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_move_backward(void);
-
-/**
- * 
- * @brief This function is used to move the car left. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_turn_left(void);
-
-/**
- * 
- * @brief This function is used to move the car right. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_turn_right(void);
-
-/**
- * 
- * @brief This function is used to stop the car. It calls another pwm helper function to stop the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_stop_car(void);
-
-#endif /* _SYSCALL_THREAD_H_ */
+/** @file   syscall_thread.h
+ *
+ *  @brief  system calls to support thread library for lab 4
+ *  @note   Not for public release, do not share
+ *
+ *  @date   last modified 25 October 2022
+ *  @author CMU 14-642
+**/
+
+#ifndef _SYSCALL_THREAD_H_
+#define _SYSCALL_THREAD_H_
+
+#include <unistd.h>
+#include<syscall_mutex.h>
+#include<mpu.h>
+#include<kernel_config.h>
+
+/** @brief TCB index of the main thread */
+#define MAIN_THREAD_ID 0
+
+/** @brief TCB index of the idle thread, user threads are 1 to MAX_THREADS */
+#define IDLE_THREAD_ID (MAX_THREADS + 1)
+
+/** @brief number of TCBs, the user threads plus main and idle */
+#define NUM_TCBS (MAX_THREADS + 2)
+
+/** @struct interrupt_stack_frame
+ *  @brief stack frame upon interrupt/exception
+ */
+typedef struct {
+    uint32_t r0;   /** @brief reg r0 value */
+    uint32_t r1;   /** @brief reg r1 value */
+    uint32_t r2;   /** @brief reg r2 value */
+    uint32_t r3;   /** @brief reg r3 value */
+    uint32_t r12;  /** @brief reg r12 value */
+    void* lr;   /** @brief reg lr value */
+    void* pc;   /** @brief reg pc value */
+    uint32_t xPSR; /** @brief reg xPSR value */
+} interrupt_stack_frame;
+
+/**
+ * 
+ * structure to store the global TCB
+ * 
+ **/
+
+typedef enum {
+    STOPPED = 0, /** task is in STOPPED state */
+    WAITING = 1, /** task is in WAITING state */
+    RUNNABLE = 2, /** task is in RUNNABLE state */
+    RUNNING = 3, /** task is in RUNNING state */
+    BLOCKED = 4, /** task is in BLOCKED state */
+    SLEEPING = 5 /** task sleeps until its wait timer expires */
+} state_t;
+
+/**
+ * 
+ * this indicates a structure which stores all the necessary contents on the psp register.
+ * Helpful in saving context. For a thread with an active FP context (bit 4 of lr clear)
+ * pendsv_asm_handler also saves S16-S31 right above this frame.
+ * 
+ **/
+
+typedef struct msp_stack_frame {
+    interrupt_stack_frame* psp; /** interrupt stack frame of the psp */
+    uint32_t r4; /** r4 register on interrupt stack frame */
+    uint32_t r5; /** r5 register on interrupt stack frame */
+    uint32_t r6; /** r6 register on interrupt stack frame */
+    uint32_t r7; /** r7 register on interrupt stack frame */
+    uint32_t r8; /** r8 register on interrupt stack frame */
+    uint32_t r9; /** r9 register on interrupt stack frame */
+    uint32_t r10; /** r10 register on interrupt stack frame */
+    uint32_t r11; /** r11 register on interrupt stack frame */
+    void* lr; /** lr register on interrupt stack frame */
+} msp_stack_frame_t;
+
+/**
+ * 
+ * this indicates a node of a kernel timer queue. Queues are kept sorted by the absolute expiry
+ * time so that the tick handler only has to look at the head of a queue.
+ * 
+ **/
+
+typedef struct ktimer {
+    uint32_t expires; /** absolute expiry time in ticks */
+    struct ktimer* next; /** next timer in the queue */
+    struct tcb* tcb; /** thread which owns the timer */
+    uint8_t queued; /** set while the timer is linked into a queue */
+} ktimer_t;
+
+/** @brief number of response time histogram buckets, bucket k > 0 counts [2^(k-1), 2^k) ticks */
+#define STATS_HIST_BUCKETS 16
+
+/**
+ * 
+ * timing statistics of a thread, all times are in scheduler ticks. A job starts at its release
+ * and ends when the thread waits for its next period or, under OVERRUN_SUSPEND, runs out of
+ * budget.
+ * 
+ **/
+
+typedef struct thread_stats {
+    uint32_t jobs; /** number of completed jobs */
+    uint32_t response_min; /** shortest release to completion time */
+    uint32_t response_max; /** longest release to completion time */
+    uint32_t response_total; /** sum of all response times */
+    uint32_t response_avg; /** average response time, filled in by sys_thread_stats */
+    uint32_t latency_min; /** shortest release to first dispatch time */
+    uint32_t latency_max; /** longest release to first dispatch time */
+    uint32_t jitter; /** release jitter, latency_max - latency_min, filled in by sys_thread_stats */
+    uint32_t overruns; /** jobs which ran out of budget */
+    uint32_t deadline_misses; /** jobs which completed after their deadline or not before the next release */
+    uint32_t hist[STATS_HIST_BUCKETS]; /** histogram of the response times */
+} thread_stats_t;
+
+/** @brief thread type, released at the start of every period */
+#define THREAD_TYPE_PERIODIC 0
+/** @brief thread type, sporadic server which runs on events out of a replenished budget */
+#define THREAD_TYPE_SERVER 1
+
+/** @brief overrun policy, a job which used up its budget waits for its next period */
+#define OVERRUN_SUSPEND 0
+/** @brief overrun policy, the job runs on below every other thread until it completes or is released again */
+#define OVERRUN_BACKGROUND 1
+/** @brief overrun policy, as OVERRUN_BACKGROUND and the overrun is reported by sys_thread_overrun */
+#define OVERRUN_NOTIFY 2
+/** @brief overrun policy, the thread is killed and the mutexes it holds go to their waiters */
+#define OVERRUN_KILL 3
+
+/** @brief exit code of a thread killed by another thread or by OVERRUN_KILL */
+#define THREAD_EXIT_KILLED (-1)
+
+/** @brief server event, console input is waiting, polled by the tick */
+#define SERVER_EVENT_CONSOLE (1 << 0)
+/** @brief server event, another thread called server_post */
+#define SERVER_EVENT_POST (1 << 1)
+
+/** @brief number of outstanding replenishments tracked per sporadic server */
+#define SERVER_MAX_REPLENISHMENTS 4
+
+/**
+ * 
+ * state of a sporadic server. The server may run while it has events to handle and budget left.
+ * The budget consumed while the server is active is given back one period after the server
+ * became active, so the server never takes more than C in any window of T.
+ * 
+ **/
+
+typedef struct server {
+    uint32_t events; /** event sources the server listens to */
+    uint32_t pending; /** events which arrived since the last server_wait */
+    uint32_t budget; /** remaining budget in ticks */
+    uint32_t activated; /** time at which the server last became active */
+    uint32_t consumed; /** budget consumed since it became active */
+    uint8_t active; /** set while the server is ready with budget left */
+    uint8_t idle; /** set while the server waits in server_wait with no events pending */
+    uint8_t repl_head; /** oldest outstanding replenishment */
+    uint8_t repl_count; /** number of outstanding replenishments */
+    uint32_t repl_at[SERVER_MAX_REPLENISHMENTS]; /** replenishment times */
+    uint32_t repl_amount[SERVER_MAX_REPLENISHMENTS]; /** replenishment amounts */
+} server_t;
+
+/**
+ * 
+ * this indicates a structure which is used to store the context of the TCB for each thread
+ * that is run on the system
+ * 
+ **/
+
+
+typedef struct tcb {
+    msp_stack_frame_t* msp; /** pointer to the msp stack frame */
+    uint32_t C; /** WCET of the the task */
+    uint32_t T; /** period of the task */
+    uint32_t prio; /** priority of the task */
+    void* fn; /** pointer to the function */
+    void* vargp; /** arguments to the thread */
+    uint32_t svc_status; /** svc status of the thread */
+    uint32_t running_time; /** current running time of the task */
+    state_t state; /** state of the task */
+    void* kernel_stack_start; /** starting of the kernel stack */
+    void* kernel_stack_end; /** ending of the kernel stack */
+    void* user_stack_start; /** starting of the user stack */
+    void* user_stack_end; /** ending of the kernel stack */
+    uint8_t stack_log2; /** log2 of the MPU region covering each stack */
+    uint8_t stack_srd; /** MPU sub-region disable bits of that region */
+    uint32_t* user_stack_mark; /** lowest word of the user stack found written, its high water mark */
+    uint32_t* kernel_stack_mark; /** lowest word of the kernel stack found written */
+    uint32_t execution_time; /** current execution time of the task */
+    uint8_t static_priority; /** static priority of the task */
+    uint8_t dynamic_priority; /** dynamic priority of the task */
+    uint32_t time_since_scheduler_start; /** cumulative time since the scheduler started */
+    struct tcb*  next; /** pointer to the nest tcb in the linked list */
+    struct kmutex_t* acquired_mutexes; /** mutexes the thread holds, most recently locked first */
+    struct tcb* wait_next; /** next waiter in the wait queue of the mutex blocking the tcb */
+    struct tcb* handoff; /** lower priority waiters handed over by an unlock, requeued when the tcb runs */
+    struct tcb** wait_queue; /** semaphore or event wait queue the tcb is linked into, NULL if none */
+    ktimer_t wait_timer; /** timeout of a blocking semaphore or event wait, or the end of a sleep */
+    uint32_t wait_mask; /** event flags waited for */
+    uint32_t wait_options; /** EVENT_WAIT_* options of the event wait */
+    uint32_t wait_result; /** set by the waker, 0 if the wait timed out */
+    struct tcb* rq_next; /** next tcb in the ready list of its priority level */
+    struct tcb* rq_prev; /** previous tcb in the ready list of its priority level */
+    uint8_t in_ready; /** set while the tcb is linked into the ready bitmap */
+    ktimer_t release_timer; /** next periodic release of the thread */
+    uint32_t deadline; /** absolute deadline of the current job, used by EDF */
+    uint32_t D; /** relative deadline of the task, D <= T */
+    uint32_t job_release; /** release time of the current job */
+    uint8_t job_active; /** set from the release of a job until it completes */
+    uint8_t job_started; /** set once the current job has been dispatched */
+    thread_stats_t stats; /** timing statistics of the thread */
+    uint64_t job_cycles; /** cycles of CPU used by the current job, checked against its budget */
+    uint8_t overrun_policy; /** OVERRUN_* policy of a periodic thread */
+    uint8_t overrun_background; /** set while the job runs on in the background after an overrun */
+    uint32_t overrun_pending; /** OVERRUN_NOTIFY overruns not yet reported by sys_thread_overrun */
+    uint8_t type; /** THREAD_TYPE_PERIODIC or THREAD_TYPE_SERVER */
+    server_t server; /** sporadic server state, used by THREAD_TYPE_SERVER */
+    int32_t exit_code; /** exit code of the last thread in the tcb, kept until the tcb is reused */
+    struct tcb* joiners; /** threads blocked in sys_thread_join until this one exits */
+} tcb_t;
+
+/**
+ * 
+ * timing attributes of a new thread, passed by pointer to sys_thread_create_attr
+ * 
+ **/
+
+typedef struct thread_attr {
+    uint32_t C; /** WCET of the task */
+    uint32_t T; /** period of the task */
+    uint32_t D; /** relative deadline of the task, 0 means D = T */
+    uint32_t type; /** THREAD_TYPE_PERIODIC or THREAD_TYPE_SERVER */
+    uint32_t events; /** SERVER_EVENT_* sources a server listens to */
+    uint32_t stack_size; /** size in words of each of the thread stacks, 0 means the thread_init size */
+    uint32_t overrun; /** OVERRUN_* policy of a periodic thread, 0 suspends the job */
+    uint32_t phase; /** release offset of a periodic thread from every period boundary, phase < T */
+    uint32_t tid; /** set to the ID of the new thread by sys_thread_create_attr */
+} thread_attr_t;
+
+/**
+ * 
+ * stack use of a thread in bytes, the used sizes are the high water marks found by the stack
+ * scan which runs while the CPU is idle
+ * 
+ **/
+
+typedef struct stack_usage {
+    uint32_t user_size; /** size of the user stack */
+    uint32_t user_used; /** most of the user stack used so far */
+    uint32_t kernel_size; /** size of the kernel stack */
+    uint32_t kernel_used; /** most of the kernel stack used so far */
+} stack_usage_t;
+
+/** @brief number of priority levels tracked by the ready bitmap, one bit per level */
+#define NUM_PRIO_LEVELS MAX_PRIO_LEVELS
+
+/** @brief number of 32 bit words in the ready bitmap */
+#define NUM_PRIO_WORDS (NUM_PRIO_LEVELS / 32)
+
+/** @brief scheduler_start mode, fixed rate SysTick interrupt on every tick */
+#define SCHED_MODE_PERIODIC 0
+/** @brief scheduler_start mode flag, one shot timer armed for the next release or budget expiry */
+#define SCHED_MODE_TICKLESS (1 << 0)
+/** @brief scheduler_start mode flag, threads run from the schedule table, see sys_sched_table_set */
+#define SCHED_MODE_TABLE (1 << 1)
+
+/** @brief thread_init policy, fixed priorities with the RMS utilization bound */
+#define SCHED_POLICY_RMS 0
+/** @brief thread_init policy, earliest deadline first with the stack resource policy for mutexes */
+#define SCHED_POLICY_EDF 1
+
+/** @brief most minor frames in a schedule table */
+#define SCHED_TABLE_MAX_FRAMES 64
+/** @brief most threads released in one minor frame */
+#define SCHED_TABLE_FRAME_SLOTS 4
+
+/**
+ * 
+ * static time triggered schedule (cyclic executive), the major frame is num_frames minor frames
+ * of minor_ticks each. At the start of a minor frame the threads of its slots are released and
+ * then run in slot order, each until it waits for its next period or runs out of budget. A job
+ * still unfinished at the end of its minor frame is descheduled as an overrun.
+ * 
+ **/
+
+typedef struct sched_table {
+    uint32_t minor_ticks; /** length of a minor frame in ticks */
+    uint32_t num_frames; /** minor frames in the major frame */
+    uint8_t slots[SCHED_TABLE_MAX_FRAMES][SCHED_TABLE_FRAME_SLOTS]; /** thread IDs released in every minor frame, in run order, 0 ends the frame */
+} sched_table_t;
+
+/** @brief initialize thread switching
+ *  @note  must be called before creating threads or scheduling
+ *
+ *  @param max_threads      max number of threads to be created
+ *  @param stack_size       stack size in words of all created stacks
+ *  @param idle_fn          function pointer for idle thread, NULL for default
+ *  @param mem_protect      mpu mode, either PER_THREAD or KERNEL_ONLY
+ *  @param max_mutexes      max number of mutexes supported
+ *  @param policy           SCHED_POLICY_RMS or SCHED_POLICY_EDF
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_thread_init(uint32_t max_threads, uint32_t stack_sizes, void* idle_fn, mpu_mode mem_protect, uint32_t max_mutexes, uint32_t policy);
+
+/** @brief create a new thread as specified, if UB allows
+ *
+ *  @param fn       thread function pointer
+ *  @param prio     thread priority, with 0 being highest
+ *  @param C        execution time (scheduler ticks)
+ *  @param T        task period (scheduler ticks)
+ *  @param vargp    thread function argument
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_thread_create(void* fn, uint32_t prio, uint32_t C, uint32_t T, void* vargp);
+
+/** @brief create a new thread with the timing attributes in attr, if the
+ *  admission test allows
+ *
+ *  @param fn       thread function pointer
+ *  @param prio     thread priority, with 0 being highest
+ *  @param attr     timing attributes of the thread, deadline may be shorter than the period
+ *  @param vargp    thread function argument
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_thread_create_attr(void* fn, uint32_t prio, thread_attr_t* attr, void* vargp);
+
+/** @brief tell the kernel to start running threads using Systick
+ *  @note  returns only after all threads complete or are killed
+ *
+ *  @param frequency  frequncy of context switches in Hz
+ *  @param mode       SCHED_MODE_PERIODIC, SCHED_MODE_TICKLESS or SCHED_MODE_TABLE
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_scheduler_start(uint32_t frequency, uint32_t mode);
+
+/** @brief load the schedule table which SCHED_MODE_TABLE runs
+ *
+ *  Only before the scheduler starts. Once a table is loaded thread creation
+ *  skips the admission test, the table is checked when it is built (see
+ *  util/sched_table_gen.py), and the scheduler only starts in table mode.
+ *  NULL unloads the table, as long as no thread skipped the test.
+ *
+ *  @param table    the table, copied by the kernel
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_sched_table_set(sched_table_t* table);
+
+/** @brief one shot timer interrupt in tickless mode, accounts the elapsed ticks
+ *  and pends a PendSV which arms the next one shot interrupt
+ */
+void tickless_c_handler();
+
+/** @brief get the current time in ticks */
+uint32_t sys_get_time();
+
+/** @brief take the running thread off the run queue until an absolute time
+ *
+ *  The wake up goes through the same timer queue and tick handling as the
+ *  wait timeouts, so a sleeping thread costs nothing until then. A periodic
+ *  release which falls inside the sleep does not wake the thread.
+ *
+ *  @param wake_at  absolute time in ticks, a time already past returns at once
+ *
+ *  @return     0 for success, -1 if the main or idle thread called it
+ */
+int sys_sleep_until(uint32_t wake_at);
+
+/** @brief same as sys_sleep_until(sys_get_time() + ticks) */
+int sys_sleep_ticks(uint32_t ticks);
+
+/** @brief converts milliseconds to scheduler ticks, rounding up
+ *
+ *  @return     the number of ticks, 0 before the scheduler is started
+ */
+uint32_t ticks_from_ms(uint32_t ms);
+
+/** @brief get the ID of the running thread, the TCB index */
+uint32_t sys_get_pid();
+
+/** @brief copy the timing statistics of a thread
+ *
+ *  @param tid      ID of the thread, as returned by getpid()
+ *  @param stats    where to copy the statistics
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_thread_stats(uint32_t tid, thread_stats_t* stats);
+
+/** @brief copy the stack high water marks of a thread
+ *
+ *  @param tid      ID of the thread, as returned by getpid(), or the idle thread
+ *  @param usage    where to copy the stack use
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_thread_stack_usage(uint32_t tid, stack_usage_t* usage);
+
+/** @brief report the overruns of the running thread under OVERRUN_NOTIFY
+ *
+ *  @return     the overruns since the last call, which are cleared
+ */
+uint32_t sys_thread_overrun();
+
+/** @brief get the dynamic priority of the running thread */
+uint32_t sys_get_priority();
+
+/** @brief get the total elapsed time for the running thread */
+uint32_t sys_thread_time();
+
+/** @brief deschedule thread and wait until next turn */
+void sys_wait_until_next_period();
+
+/** @brief sporadic server only, wait until an event arrives
+ *
+ *  @return     the SERVER_EVENT_* bits which arrived, -1 if the caller is not a server
+ */
+int sys_server_wait();
+
+/** @brief signal a sporadic server, safe to call from interrupt handlers
+ *
+ *  @param tid      ID of the server thread
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_server_post(uint32_t tid);
+
+/** @brief kill the running thread
+ *
+ *  @note  locks if main or idle thread is running or thread holds a mutex
+ *
+ *  @return does not return
+ */
+void sys_thread_kill();
+
+/** @brief end the running thread with an exit code for its joiners
+ *
+ *  @param exit_code    returned by sys_thread_join
+ *
+ *  @return does not return
+ */
+void sys_thread_exit(int32_t exit_code);
+
+/** @brief kill a thread by ID, its exit code is THREAD_EXIT_KILLED
+ *
+ *  @param tid      ID of the thread, the running thread kills itself
+ *
+ *  @return     0 for success, -1 if there is no such thread or it holds or waits for a mutex
+ */
+int sys_thread_kill_tid(uint32_t tid);
+
+/** @brief wait until a thread exits
+ *
+ *  @param tid          ID of the thread
+ *  @param exit_code    where to store its exit code, may be NULL
+ *
+ *  @return     0 for success, -1 for failure
+ */
+int sys_thread_join(uint32_t tid, int32_t* exit_code);
+
+/**
+ * 
+ * @brief RMS scheduler which is used to find the highest priority task based on the time period
+ * of each task.
+ * 
+ * @param[in] none
+ * 
+ * @return returns the ID of the thread 
+ * 
+ **/
+
+uint32_t RMS();
+
+/**
+ * 
+ * @brief EDF scheduler, picks the ready thread with the earliest absolute deadline. Under the
+ * stack resource policy a thread may only run if its static priority (its preemption level) is
+ * above the ceiling of every locked mutex, or if it owns the mutex which sets the ceiling.
+ * 
+ * @param[in] none
+ * 
+ * @return returns the ID of the thread 
+ * 
+ **/
+
+uint32_t EDF();
+
+/**
+ * 
+ * @brief Used to change the state of a thread. Keeps the ready bitmap in sync, a thread is
+ * linked into the ready list of its dynamic priority while it is RUNNABLE or RUNNING. Under
+ * EDF the thread is linked into the single deadline ordered ready list instead.
+ * 
+ * @param[in] pointer to the tcb of the thread
+ * @param[in] new state of the thread
+ * 
+ * @return none
+ * 
+ **/
+
+void thread_set_state(tcb_t* tcb, state_t state);
+
+/**
+ * 
+ * @brief Used to change the dynamic priority of a thread. A ready thread is moved to the ready
+ * list of its new priority level, at the head if it was boosted above its static priority.
+ * 
+ * @param[in] pointer to the tcb of the thread
+ * @param[in] new dynamic priority
+ * 
+ * @return none
+ * 
+ **/
+
+void thread_set_dynamic_priority(tcb_t* tcb, uint8_t prio);
+
+/**
+ * 
+ * @brief Inserts a timer into a timer queue, after any timer which expires at the same time.
+ * 
+ * @param[in] pointer to the head of the queue
+ * @param[in] pointer to the timer, expires must already be set
+ * 
+ * @return none
+ * 
+ **/
+
+void timer_queue_insert(ktimer_t** queue, ktimer_t* timer);
+
+/**
+ * 
+ * @brief Removes a timer from a timer queue, does nothing if the timer is not queued.
+ * 
+ * @param[in] pointer to the head of the queue
+ * @param[in] pointer to the timer
+ * 
+ * @return none
+ * 
+ **/
+
+void timer_queue_remove(ktimer_t** queue, ktimer_t* timer);
+
+/** @brief timeout of a blocking wait which never expires */
+#define WAIT_FOREVER __UINT32_MAX__
+
+/**
+ * 
+ * @brief Links a tcb into a wait queue, after every waiter of the same or higher dynamic priority.
+ * 
+ * @param[in] pointer to the head of the queue
+ * @param[in] pointer to the tcb
+ * 
+ * @return none
+ * 
+ **/
+
+void wait_queue_insert(tcb_t** queue, tcb_t* tcb);
+
+/**
+ * 
+ * @brief Blocks the running thread on a wait queue until thread_wake is called for it or the
+ * timeout expires. Must be called from an SVC, inside the critical section in which the caller
+ * found it has to wait so that no wake up is lost, the section ends before the thread blocks.
+ * 
+ * @param[in] pointer to the head of the queue
+ * @param[in] timeout in scheduler ticks, WAIT_FOREVER for none
+ * @param[in] interrupt state saved by the caller's save_interrupt_state_and_disable
+ * 
+ * @return the result passed to thread_wake, 0 on timeout
+ * 
+ **/
+
+uint32_t thread_wait(tcb_t** queue, uint32_t timeout, int interrupt_status);
+
+/**
+ * 
+ * @brief Ends the wait of a thread blocked in thread_wait and makes it runnable, a PendSV is
+ * pended if it should preempt the running thread. Safe to call from interrupt handlers.
+ * 
+ * @param[in] pointer to the tcb of the waiter
+ * @param[in] result returned by thread_wait, non zero
+ * 
+ * @return none
+ * 
+ **/
+
+void thread_wake(tcb_t* tcb, uint32_t result);
+
+/**
+ * 
+ * @brief Utilization bound test of the fixed priority task set with the new task added, in
+ * fixed point against sums kept as threads are created and killed. Only decides task sets with
+ * distinct rate monotonic priorities, D = T and no mutexes under the bound, and task sets whose
+ * utilization is over 1.
+ * 
+ * @param[in] priority of the task
+ * @param[in] WCET of the task
+ * @param[in] Time period of the task 
+ * @param[in] relative deadline of the task
+ * 
+ * @return 1 if schedulable, -1 if not, 0 if RTA_test_RMS has to decide
+ * 
+ * */
+
+int UB_test_RMS(uint32_t prio, uint32_t C, uint32_t T, uint32_t D);
+
+/**
+ * 
+ * @brief Exact response time analysis of the fixed priority task set with the new task added.
+ * Every task must finish within its relative deadline in the worst case, which is its own
+ * WCET, one critical section of a lower priority task (taken as its whole WCET) if any mutex
+ * ceiling reaches the task's priority, and the preemptions by tasks of higher or equal priority.
+ * 
+ * @param[in] priority of the task
+ * @param[in] WCET of the task
+ * @param[in] Time period of the task 
+ * @param[in] relative deadline of the task
+ * 
+ * @return 0 if schedulable, -1 otherwise
+ * 
+ * */
+
+int RTA_test_RMS(uint32_t prio, uint32_t C, uint32_t T, uint32_t D);
+
+/**
+ * 
+ * @brief Used to perform the EDF density test, the task set is schedulable as long as the sum
+ * of C / D including the new task does not exceed 1. With D = T this is the exact utilization
+ * test. O(1) in fixed point against the density sum of the live threads.
+ * 
+ * @param[in] WCET of the task
+ * @param[in] relative deadline of the task
+ * 
+ * @return 0 if schedulable, -1 otherwise
+ * 
+ * */
+
+int UB_test_EDF(uint32_t C, uint32_t D);
+
+/**
+ * 
+ * @brief This function is used to read the lux sensor. This is a system call which gets
+ * called when the stub for the specific user function is pressed. 
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_read_lux();
+
+/**
+ * 
+ * @brief This function is used to read the microphone. This is a system call which gets
+ * called when the stub for the specific user function is pressed. 
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_read_mic();
+
+/**
+ * 
+ * @brief This function is system call which is used to glow the led. This is called
+ * via a stub from the user space function.
+ * 
+ * @param[in] If the user gives 0 then the leds turn off. Else, then remain on.
+ * 
+ * @return none
+ * 
+ */
+
+void sys_glow_led(int on);
+
+/**
+ * 
+ * @brief This function is used to move the car forward. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_move_forward(void);
+
+/**
+ * 
+ * @brief This function is used to move the car backward. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_move_backward(void);
+
+/**
+ * 
+ * @brief This function is used to move the car left. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_turn_left(void);
+
+/**
+ * 
+ * @brief This function is used to move the car right. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_turn_right(void);
+
+/**
+ * 
+ * @brief This function is used to stop the car. It calls another pwm helper function to stop the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_stop_car(void);
+
+#endif /* _SYSCALL_THREAD_H_ */
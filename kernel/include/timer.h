@@ -18,6 +18,14 @@
 #define COUNTFLAG (1 << 16) /** bit 16 to check if the counter value has reached 0 */
 #define COUNTFLAGMASK (1 << 16) /** mask to check if the counter had reached 0 */
 #define MAXCNTVAL 0x00FFFFFF
+#define PROC_FREQ 64000000 /** core clock in Hz, also the rate of the DWT cycle counter */
+
+#define ONESHOT_TIMER (uint32_t*)0x40009000 /** TIMER1, counter and compare for tickless mode */
+#define ONESHOT_TIMER_EXCEPTION_NUMBER 9 /** TIMER1 interrupt number */
+#define ONESHOT_TIMER_PRESCALER 4 /** 16MHz / 2^4 */
+#define ONESHOT_TIMER_FREQ 1000000 /** counter frequency of the one shot timer in Hz */
+#define ONESHOT_TIMER_BITMODE_32 3 /** 32 bit counter */
+#define ONESHOT_TIMER_INT_COMPARE0 (1 << 16) /** interrupt on COMPARE[0] */
 /**
  * 
  * @brief This structure indicates the memory map of the region which will store the necessary
@@ -36,6 +44,38 @@ typedef struct sysTick {
     volatile uint32_t SYST_CALIB; /** SysTick Calibration Value Register */
 } systick_t;
 
+/**
+ * 
+ * @brief This structure indicates the memory map of the nRF52840 TIMER peripheral which is used
+ * as a free running counter with a compare channel to generate one shot interrupts in tickless mode.
+ * Channel 0 holds the next compare value, channel 1 is used to capture the current count.
+ * 
+ **/
+
+typedef struct oneshot_timer {
+    volatile uint32_t tasks_start; /** start the counter */
+    volatile uint32_t tasks_stop; /** stop the counter */
+    volatile uint32_t tasks_count; /** increment the counter, counter mode only */
+    volatile uint32_t tasks_clear; /** clear the counter */
+    volatile uint32_t tasks_shutdown; /** shut the timer down */
+    char pad0[44]; /** padding between registers */
+    volatile uint32_t tasks_capture[6]; /** capture the counter into CC[n] */
+    char pad1[232]; /** padding between registers */
+    volatile uint32_t events_compare[6]; /** counter matched CC[n] */
+    char pad2[168]; /** padding between registers */
+    volatile uint32_t shorts; /** shortcuts between events and tasks */
+    char pad3[256]; /** padding between registers */
+    volatile uint32_t intenset; /** interrupt enable set */
+    volatile uint32_t intenclr; /** interrupt enable clear */
+    char pad4[504]; /** padding between registers */
+    volatile uint32_t mode; /** timer or counter mode */
+    volatile uint32_t bitmode; /** counter width */
+    char pad5[4]; /** padding between registers */
+    volatile uint32_t prescaler; /** 16MHz / 2^prescaler */
+    char pad6[44]; /** padding between registers */
+    volatile uint32_t cc[6]; /** capture compare registers */
+} oneshot_timer_t;
+
 /**
  * 
  * @brief function is used to start the systick and allow it to generate interrupts at the 
@@ -68,4 +108,54 @@ void systick_stop();
 
 void systick_delay(uint32_t ms);
 
+/**
+ * 
+ * @brief Starts the one shot timer as a free running 32 bit counter at ONESHOT_TIMER_FREQ.
+ * The counter starts from 0 and no compare interrupt is armed.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return
+ * 
+ **/
+
+void oneshot_timer_start();
+
+/**
+ * 
+ * @brief Stops the one shot timer and disables its interrupt.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return
+ * 
+ **/
+
+void oneshot_timer_stop();
+
+/**
+ * 
+ * @brief Reads the current value of the free running counter.
+ * 
+ * @param[in] none
+ * 
+ * @return counter value in ONESHOT_TIMER_FREQ units
+ * 
+ **/
+
+uint32_t oneshot_timer_now();
+
+/**
+ * 
+ * @brief Arms the compare interrupt for an absolute counter value. If the value has already
+ * passed by the time it is armed the interrupt is pended straight away.
+ * 
+ * @param[in] absolute counter value at which to interrupt
+ * 
+ * @return does not return
+ * 
+ **/
+
+void oneshot_timer_set(uint32_t count);
+
 #endif /* _TIMER_H_ */
\ No newline at end of file
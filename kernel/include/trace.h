@@ -0,0 +1,75 @@
+/** @file   trace.h
+ *
+ *  @brief  binary scheduler event trace on RTT up channel RTT_TRACE_BUFFER
+ *
+ *  Every event is one 8 byte trace_record_t written straight into the
+ *  trace channel's ring buffer, which the debugger drains. A record which
+ *  does not fit is dropped rather than waited for, the next one that fits
+ *  is preceded by a TRACE_DROPPED record with the number lost. Decode a
+ *  capture of the channel with util/trace_decode.py. Tracing only exists
+ *  in TRACE builds (make TRACE=1), otherwise the calls compile to nothing.
+**/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <unistd.h>
+#include <stdint.h>
+
+/** @brief trace record types, keep util/trace_decode.py in sync */
+//@{
+#define TRACE_SWITCH       1  /** tid switched in, arg is the thread switched out */
+#define TRACE_RELEASE      2  /** tid released a new job */
+#define TRACE_BLOCK        3  /** tid stopped being runnable, arg is its new state_t */
+#define TRACE_UNBLOCK      4  /** tid woken from BLOCKED or SLEEPING */
+#define TRACE_MUTEX_LOCK   5  /** tid took mutex number arg */
+#define TRACE_MUTEX_UNLOCK 6  /** tid released mutex number arg */
+#define TRACE_SVC_ENTER    7  /** tid made syscall number arg */
+#define TRACE_SVC_EXIT     8  /** tid returned from syscall number arg */
+#define TRACE_ISR_ENTER    9  /** exception number arg interrupted tid */
+#define TRACE_ISR_EXIT     10 /** exception number arg returns to tid */
+#define TRACE_DROPPED      11 /** arg records were dropped just before this one */
+//@}
+
+/**
+ * @brief      One trace event, little endian on the wire.
+ */
+typedef struct {
+  uint32_t cycles; // DWT cycle count, wraps every 2^32 cycles /
+  uint8_t type; // TRACE_* /
+  uint8_t tid; // thread, an index into TCB /
+  uint16_t arg; // meaning depends on type /
+} trace_record_t;
+
+#ifdef TRACE
+
+void trace_thread_event(uint32_t type, uint32_t tid, uint32_t arg);
+void trace_event(uint32_t type, uint32_t arg);
+
+/** @brief number of the exception being handled, 0 in thread mode */
+__attribute__((always_inline)) static inline uint32_t trace_exception_number() {
+    uint32_t ipsr;
+    __asm volatile("mrs %0, ipsr" : "=r" (ipsr));
+    return ipsr & 0x1FF;
+}
+
+/** @brief trace entry to the running exception handler */
+__attribute__((always_inline)) static inline void trace_isr_enter() {
+    trace_event(TRACE_ISR_ENTER, trace_exception_number());
+}
+
+/** @brief trace exit from the running exception handler */
+__attribute__((always_inline)) static inline void trace_isr_exit() {
+    trace_event(TRACE_ISR_EXIT, trace_exception_number());
+}
+
+#else
+
+__attribute__((always_inline)) static inline void trace_thread_event(uint32_t type, uint32_t tid, uint32_t arg) { (void)type; (void)tid; (void)arg; }
+__attribute__((always_inline)) static inline void trace_event(uint32_t type, uint32_t arg) { (void)type; (void)arg; }
+__attribute__((always_inline)) static inline void trace_isr_enter() {}
+__attribute__((always_inline)) static inline void trace_isr_exit() {}
+
+#endif /* TRACE */
+
+#endif /* _TRACE_H_ */
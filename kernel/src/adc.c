@@ -13,6 +13,8 @@
 #include<gpio.h>
 #include<arm.h>
 #include<rfft.h>
+#include <probe.h>
+#include <trace.h>
 
 volatile int16_t result;
 
@@ -79,6 +81,8 @@ int16_t adc_read_pin() {
 }
 
 void SAADC_IRQHandler() {
+    uint32_t start = probe_enter();
+    trace_isr_enter();
 
     //printk("Read %d samples\n",adc->result_amount);
     for(int i = 0; i < FFT_SIZE; i++) {
@@ -91,4 +95,7 @@ void SAADC_IRQHandler() {
     adc->events_resultdone = 0;
     adc->events_calibrateddone = 0;
     adc->events_stopped = 0;
+
+    trace_isr_exit();
+    probe_exit(PROBE_SAADC, start);
 }
@@ -37,6 +37,12 @@
 /** @brief FPU control data */
 #define FPCCR ((volatile uint32_t *) 0xE000EF34)
 
+/** @brief Debug exception and monitor control register */
+#define DEMCR ((volatile uint32_t *) 0xE000EDFC)
+
+/** @brief DWT control register */
+#define DWT_CTRL ((volatile uint32_t *) 0xE0001000)
+
 /** @brief disable stack alignment and set SVC handler priority */
 void init_align_prio() {
     // stack alignment
@@ -64,10 +70,10 @@ void enable_prefetch_i_cache(){
     *ICACHECNF |= (0x1 << 0);
 }
 
-/** @brief enable the FPU */
+/** @brief enable the FPU, with automatic and lazy stacking of the FP context on exceptions */
 void enable_fpu(){
     *CPACR |= (0xF << 20);
-    *FPCCR |= (0x1 << 31);
+    *FPCCR |= (0x1 << 31) | (0x1 << 30);
     __asm volatile("dsb");
     __asm volatile("isb");
 }
@@ -96,3 +102,12 @@ void set_svc_status(int status) {
 void set_enable_memfault() {
     *SHCSR |= (1 << 16);
 }
+
+/** @brief enable the DWT cycle counter and reset it to 0 */
+void enable_cycle_counter() {
+    // trace enable, required before any DWT register can be used
+    *DEMCR |= (1 << 24);
+    *DWT_CYCCNT = 0;
+    // CYCCNTENA
+    *DWT_CTRL |= (1 << 0);
+}
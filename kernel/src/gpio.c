@@ -12,6 +12,8 @@
 #include <gpio.h>
 #include<printk.h>
 #include<pix.h>
+#include <probe.h>
+#include <trace.h>
 
 gpio_t* led; // global GPIO instance
 pwm_t* onboard_led;
@@ -302,6 +304,8 @@ void enable_user_sw_and_reset() {
 
 
 void GPIOTE_IRQHandler() {
+    uint32_t start = probe_enter();
+    trace_isr_enter();
     volatile uint32_t* aircr_register = (volatile uint32_t*)AIRCR;
 
     if(user_sw->gpiote_events_in.event[0]){
@@ -318,7 +322,9 @@ void GPIOTE_IRQHandler() {
 
         
     }
-    
+
+    trace_isr_exit();
+    probe_exit(PROBE_GPIOTE, start);
 }
 /**
  * 
@@ -51,6 +51,11 @@ extern char* __msp_stack_limit;
 int kernel_main() {
     init_align_prio();          // <-- do not remove
 
+    // the kernel is built for the hard float ABI, enable the FPU before any C code can use it
+    enable_fpu();
+
+    enable_cycle_counter();
+
     // enter_user_mode();
     pix_init();
 
@@ -0,0 +1,135 @@
+/** @file   probe.c
+ *
+ *  @brief  accumulators of the cycle counting probes, see probe.h
+**/
+
+#include <arm.h>
+#include <printk.h>
+#include <probe.h>
+
+#ifdef PROFILE
+
+/** @brief probe names, indexed by probe id */
+static const char* const probe_names[NUM_PROBES] = {
+    "svc", "pendsv", "systick", "saadc", "gpiote"
+};
+
+volatile uint32_t probe_switch_count = 0;
+
+static probe_stats_t probes[NUM_PROBES] = {
+    [0 ... NUM_PROBES - 1] = { .min = __UINT32_MAX__ }
+};
+
+/**
+ *
+ * @brief End of a probe point, adds the cycles since start to the probe.
+ *
+ * @param[in] probe id
+ * @param[in] cycle count returned by probe_enter()
+ *
+ * @return does not return any value
+ *
+ **/
+
+void probe_exit(uint32_t probe, uint32_t start) {
+    uint32_t cycles = get_cycle_count() - start;
+    probe_stats_t* p = &probes[probe];
+
+    // a higher priority exception only runs a probe of its own, a different one
+    p->count++;
+    p->total += cycles;
+    if (cycles < p->min) p->min = cycles;
+    if (cycles > p->max) p->max = cycles;
+}
+
+/**
+ *
+ * @brief End of a probe point in thread context. If the thread was switched out in between the
+ * cycles are mostly other threads', so the exit is only counted in blocked.
+ *
+ * @param[in] probe id
+ * @param[in] cycle count returned by probe_enter()
+ * @param[in] probe_switches() at the same time
+ *
+ * @return does not return any value
+ *
+ **/
+
+void probe_exit_thread(uint32_t probe, uint32_t start, uint32_t switches) {
+    if (switches != probe_switch_count) {
+        probes[probe].blocked++;
+        return;
+    }
+    probe_exit(probe, start);
+}
+
+void probe_print() {
+    for (uint32_t i = 0; i < NUM_PROBES; i++) {
+        probe_stats_t* p = &probes[i];
+        if ((p->count == 0) && (p->blocked == 0)) {
+            continue;
+        }
+
+        uint32_t total_hi = (uint32_t)(p->total >> 32);
+        uint32_t total_lo = (uint32_t)p->total;
+
+        // no 64 bit printk, very large totals are printed in hex
+        if (total_hi != 0) {
+            printk("probe %s: count %lu total 0x%lx%08lx min %lu max %lu blocked %lu\n", probe_names[i],
+                p->count, total_hi, total_lo, p->min, p->max, p->blocked);
+        } else {
+            printk("probe %s: count %lu total %lu min %lu max %lu blocked %lu\n", probe_names[i],
+                p->count, total_lo, (p->count != 0) ? p->min : 0, p->max, p->blocked);
+        }
+    }
+}
+
+int sys_probe_dump(probe_stats_t* stats, uint32_t n, uint32_t flags) {
+    if (n > NUM_PROBES) {
+        n = NUM_PROBES;
+    }
+
+    // a consistent snapshot, every exception handler updates its probe
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    if (stats != NULL) {
+        uint32_t* dst = (uint32_t*)stats;
+        uint32_t* src = (uint32_t*)probes;
+        for (uint32_t i = 0; i < (n * sizeof(probe_stats_t) / sizeof(uint32_t)); i++) {
+            dst[i] = src[i];
+        }
+    }
+
+    if (flags & PROBE_DUMP_PRINT) {
+        probe_print();
+    }
+
+    if (flags & PROBE_DUMP_RESET) {
+        for (uint32_t i = 0; i < NUM_PROBES; i++) {
+            probes[i].total = 0;
+            probes[i].count = 0;
+            probes[i].min = __UINT32_MAX__;
+            probes[i].max = 0;
+            probes[i].blocked = 0;
+        }
+    }
+
+    restore_interrupt_state(interrupt_status);
+
+    return NUM_PROBES;
+}
+
+#else
+
+void probe_print() {
+}
+
+int sys_probe_dump(probe_stats_t* stats, uint32_t n, uint32_t flags) {
+    (void)stats;
+    (void)n;
+    (void)flags;
+    printk("Probes need a PROFILE=1 build\n");
+    return -1;
+}
+
+#endif /* PROFILE */
@@ -22,6 +22,9 @@ extern rtt_control_t __rtt_start;
 
 static char up_buffer[BUFFER_SIZE_UP];
 static char down_buffer[BUFFER_SIZE_DOWN];
+#ifdef TRACE
+static char trace_buffer[BUFFER_SIZE_TRACE];
+#endif
 
 /*
  * @brief: initialize control blocks, must be called before any other rtt ops
@@ -41,6 +44,16 @@ void rtt_init() {
   p->up_buffers[0].pos_wr = 0;
   p->up_buffers[0].flags = 2;
 
+#ifdef TRACE
+  // flags 0, the host is told records which do not fit are skipped
+  p->up_buffers[RTT_TRACE_BUFFER].name = "Trace";
+  p->up_buffers[RTT_TRACE_BUFFER].p_buffer = trace_buffer;
+  p->up_buffers[RTT_TRACE_BUFFER].buffer_size = BUFFER_SIZE_TRACE;
+  p->up_buffers[RTT_TRACE_BUFFER].pos_rd = 0;
+  p->up_buffers[RTT_TRACE_BUFFER].pos_wr = 0;
+  p->up_buffers[RTT_TRACE_BUFFER].flags = 0;
+#endif
+
   p->down_buffers[0].name = "Terminal";
   p->down_buffers[0].p_buffer = down_buffer;
   p->down_buffers[0].buffer_size = BUFFER_SIZE_DOWN;
@@ -59,7 +72,7 @@ void rtt_init() {
 }
 
 /**
- * @brief pushes an array of unformatted characters into the 0th RTT up buffer, which the host will print to the console
+ * @brief pushes an array of unformatted characters into an RTT up buffer, buffer 0 is the one the host prints to the console
  * any write operation will spin within a while loop any time the buffer is full, waiting until the host consumes the corresponding characters
  * to free up space
  *
@@ -70,10 +83,12 @@ void rtt_init() {
  * @return number of written bytes
  */
 uint32_t rtt_write(uint32_t buffer_index, const void* p_buffer, uint32_t num_bytes) {
-  (void)buffer_index;
   uint32_t count = 0;
   rtt_buffer_up_t* p;
-  p = &__rtt_start.up_buffers[0];
+  if (buffer_index >= RTT_MAX_UP_BUFFERS) {
+    return 0;
+  }
+  p = &__rtt_start.up_buffers[buffer_index];
   for (uint32_t i=0; i < num_bytes; i++){
     while ((p->pos_rd - p->pos_wr) == 1 || ((p->pos_wr == (p->buffer_size -1)) && (p->pos_rd == 0))) {
         // spinning for reader to move forward
@@ -86,6 +101,45 @@ uint32_t rtt_write(uint32_t buffer_index, const void* p_buffer, uint32_t num_byt
   return count;
 }
 
+/**
+ * @brief pushes an array of bytes into an RTT up buffer only if all of them fit right now, never waits for the host
+ *
+ * @params[in]  index of up buffer used for writing
+ * @params[in]  p_buffer Buffer that holds the input data
+ * @params[in]  num_bytes number of bytes to write
+ *
+ * @return num_bytes if they were written, 0 if the buffer did not have room
+ */
+uint32_t rtt_write_nonblocking(uint32_t buffer_index, const void* p_buffer, uint32_t num_bytes) {
+  rtt_buffer_up_t* p;
+  if (buffer_index >= RTT_MAX_UP_BUFFERS) {
+    return 0;
+  }
+  p = &__rtt_start.up_buffers[buffer_index];
+
+  // one byte stays free so that a full buffer is distinguishable from an empty one
+  uint32_t pos_rd = p->pos_rd;
+  uint32_t pos_wr = p->pos_wr;
+  uint32_t space = (pos_rd > pos_wr) ? (pos_rd - pos_wr - 1) : (p->buffer_size - pos_wr + pos_rd - 1);
+  if (space < num_bytes) {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < num_bytes; i++) {
+    p->p_buffer[pos_wr] = ((const char*)p_buffer)[i];
+    pos_wr++;
+    if (pos_wr == p->buffer_size) {
+      pos_wr = 0;
+    }
+  }
+
+  // the data has to be in the buffer before the host sees the new write position
+  RTT__DMB();
+  p->pos_wr = pos_wr;
+
+  return num_bytes;
+}
+
 /**
  * @brief function that grabs characters from the host out of the 0th down buffer, for consumption by the device
  * read operation will spin any time the buffer is empty
@@ -0,0 +1,163 @@
+/** @file   stack_alloc.c
+ *
+ *  @brief  buddy allocator for the thread stack regions
+ *
+ *  The blocks form a complete binary tree, node 1 is the whole region and
+ *  the children of node n are 2n and 2n + 1. The nodes of blocks of size
+ *  1 << k are numbered from 1 << (pool log2 - k), so the free bitmap of
+ *  every size is a contiguous run of bits and count_leading_zeros finds the
+ *  lowest free block of a size a word at a time.
+**/
+
+#include <arm.h>
+#include <mpu.h>
+#include <stack_alloc.h>
+
+/** @brief free bit of tree node n */
+//@{
+#define NODE_WORD(n) ((n) >> 5)
+#define NODE_BIT(n)  (1U << (31 - ((n) & 31)))
+//@}
+
+/**
+ * 
+ * @brief Returns the lowest free node of blocks of size 1 << log2.
+ * 
+ * @param[in] pool to search
+ * @param[in] log2 of the block size
+ * 
+ * @return the node, 0 if no block of that size is free
+ * 
+ **/
+
+static uint32_t stack_pool_find(stack_pool_t* pool, uint32_t log2) {
+    uint32_t lo = 1U << (pool->log2 - log2);
+    uint32_t hi = lo << 1;
+
+    for (uint32_t w = NODE_WORD(lo); w <= NODE_WORD(hi - 1); w++) {
+        uint32_t bits = pool->free[w];
+        // levels of less than 32 nodes share word 0 with the levels above them
+        if (lo < 32) {
+            bits &= (0xFFFFFFFFU >> lo);
+            if (hi < 32) {
+                bits &= ~(0xFFFFFFFFU >> hi);
+            }
+        }
+        if (bits) {
+            return (w << 5) + count_leading_zeros(bits);
+        }
+    }
+    return 0;
+}
+
+/**
+ * 
+ * @brief Frees one block, merging it with its buddy as long as the buddy is free.
+ * 
+ * @param[in] pool the block belongs to
+ * @param[in] offset of the block in the region, aligned to its size
+ * @param[in] log2 of the block size
+ * 
+ * @return none
+ * 
+ **/
+
+static void stack_pool_free_block(stack_pool_t* pool, uint32_t offset, uint32_t log2) {
+    uint32_t n = (1U << (pool->log2 - log2)) + (offset >> log2);
+
+    while ((n > 1) && (pool->free[NODE_WORD(n ^ 1)] & NODE_BIT(n ^ 1))) {
+        pool->free[NODE_WORD(n ^ 1)] &= ~NODE_BIT(n ^ 1);
+        n >>= 1;
+    }
+    pool->free[NODE_WORD(n)] |= NODE_BIT(n);
+}
+
+/**
+ * 
+ * @brief Frees [start, end) of the region as the largest aligned blocks which fit.
+ * 
+ * @param[in] pool the range belongs to
+ * @param[in] offset of the start of the range, a multiple of 1 << STACK_MIN_LOG2
+ * @param[in] offset of the end of the range, a multiple of 1 << STACK_MIN_LOG2
+ * 
+ * @return none
+ * 
+ **/
+
+static void stack_pool_free_range(stack_pool_t* pool, uint32_t start, uint32_t end) {
+    while (start < end) {
+        uint32_t log2 = STACK_MIN_LOG2;
+        while ((log2 < pool->log2) && !(start & (1U << log2)) && (start + (2U << log2) <= end)) {
+            log2++;
+        }
+        stack_pool_free_block(pool, start, log2);
+        start += (1U << log2);
+    }
+}
+
+int stack_pool_init(stack_pool_t* pool, void* base, uint32_t size) {
+    uint32_t log2 = mm_log2ceil_size(size);
+
+    if ((size != (1U << log2)) || (log2 < STACK_MIN_LOG2) || (log2 > STACK_POOL_MAX_LOG2)
+        || ((uint32_t)base & (size - 1))) {
+        return -1;
+    }
+
+    pool->base = (char*)base;
+    pool->log2 = log2;
+    for (uint32_t w = 0; w < STACK_POOL_NODES / 32; w++) {
+        pool->free[w] = 0;
+    }
+    pool->free[NODE_WORD(1)] |= NODE_BIT(1);
+    return 0;
+}
+
+int stack_pool_alloc(stack_pool_t* pool, uint32_t size, stack_block_t* block) {
+    if ((size == 0) || (size > (1U << pool->log2))) {
+        return -1;
+    }
+
+    uint32_t log2 = mm_log2ceil_size(size);
+    if (log2 < STACK_MIN_LOG2) {
+        log2 = STACK_MIN_LOG2;
+    }
+
+    // smallest free block which is large enough, split down to the size wanted
+    uint32_t n = 0;
+    uint32_t level = log2;
+    for (; level <= pool->log2; level++) {
+        n = stack_pool_find(pool, level);
+        if (n) {
+            break;
+        }
+    }
+    if (n == 0) {
+        return -1;
+    }
+    pool->free[NODE_WORD(n)] &= ~NODE_BIT(n);
+    for (; level > log2; level--) {
+        n <<= 1;
+        pool->free[NODE_WORD(n + 1)] |= NODE_BIT(n + 1);
+    }
+    uint32_t offset = (n - (1U << (pool->log2 - log2))) << log2;
+
+    // the stack grows down, keep the top eighths it needs and disable the rest
+    uint32_t unused = 0;
+    block->srd = 0;
+    if (log2 >= STACK_SRD_MIN_LOG2) {
+        uint32_t sub = 1U << (log2 - 3);
+        unused = 8 - ((size + sub - 1) / sub);
+        block->srd = (uint8_t)((1U << unused) - 1);
+        unused *= sub;
+        stack_pool_free_range(pool, offset, offset + unused);
+    }
+
+    block->start = pool->base + offset + unused;
+    block->end = pool->base + offset + (1U << log2);
+    block->region_log2 = (uint8_t)log2;
+    return 0;
+}
+
+void stack_pool_free(stack_pool_t* pool, void* start, void* end) {
+    stack_pool_free_range(pool, (uint32_t)((char*)start - pool->base), (uint32_t)((char*)end - pool->base));
+}
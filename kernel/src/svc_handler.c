@@ -16,12 +16,43 @@
 #include<pix.h>
 #include <syscall_thread.h>
 #include <syscall_mutex.h>
+#include <syscall_sem.h>
+#include <syscall_msgq.h>
 #include<visualiser.h>
 #include<radio.h>
+#include <probe.h>
+#include <trace.h>
 
-void svc_c_handler(void* stk_ptr) {
+/** @brief words in the basic exception frame, r0-r3, r12, lr, pc and xPSR */
+#define FRAME_WORDS_BASIC 8
+/** @brief words in the extended exception frame, S0-S15, FPSCR and a reserved word follow xPSR */
+#define FRAME_WORDS_EXTENDED 26
+
+/**
+ * @brief  locate the caller's arguments past r0-r3, which it left on its stack
+ *
+ * The frame is extended with the FP state when EXC_RETURN bit 4 is clear, and
+ * the core inserted a padding word to align it when xPSR bit 9 is set.
+ *
+ * @param  stack       the exception frame on the psp
+ * @param  exc_return  lr on entry to the handler
+ *
+ * @return pointer to the fifth argument
+ */
+static uint32_t* svc_stacked_args(interrupt_stack_frame* stack, uint32_t exc_return) {
+    uint32_t* args = (uint32_t*)stack;
+    args += (exc_return & 0x10) ? FRAME_WORDS_BASIC : FRAME_WORDS_EXTENDED;
+    if(stack->xPSR & (1 << 9))
+        args++;
+    return args;
+}
+
+void svc_c_handler(void* stk_ptr, uint32_t exc_return) {
     //breakpoint();
 
+    uint32_t probe_start = probe_enter();
+    uint32_t probe_switch = probe_switches();
+
     uint8_t svc_num = -1;
     uint32_t* pc_ptr; 
 
@@ -31,6 +62,7 @@ void svc_c_handler(void* stk_ptr) {
     uint32_t* pc = (uint32_t*)stack->pc;
     pc_ptr = (uint32_t*)((char*)pc - 2);
     svc_num = (uint8_t)((*pc_ptr) & ((uint32_t)0xff));
+    trace_event(TRACE_SVC_ENTER, svc_num);
 
     int len;
     int file;
@@ -93,9 +125,24 @@ void svc_c_handler(void* stk_ptr) {
         uint32_t stack_size = stack->r1;
         void* idle_fn = (void*)stack->r2;
         mpu_mode memory_protection = (mpu_mode)stack->r3;
-        uint32_t max_mutexes = (uint32_t)(*((char*)stk_ptr + 0x20));
+        uint32_t max_mutexes = svc_stacked_args(stack, exc_return)[0];
+
+        stack->r0 = sys_thread_init(max_threads, stack_size, idle_fn, memory_protection, max_mutexes, SCHED_POLICY_RMS);
+
+        break;
+        }
+
+        case SVC_THR_INIT_POLICY:
+        {
+        uint32_t max_threads = stack->r0;
+        uint32_t stack_size = stack->r1;
+        void* idle_fn = (void*)stack->r2;
+        mpu_mode memory_protection = (mpu_mode)stack->r3;
+        uint32_t* args = svc_stacked_args(stack, exc_return);
+        uint32_t max_mutexes = args[0];
+        uint32_t policy = args[1];
 
-        stack->r0 = sys_thread_init(max_threads, stack_size, idle_fn, memory_protection, max_mutexes);
+        stack->r0 = sys_thread_init(max_threads, stack_size, idle_fn, memory_protection, max_mutexes, policy);
 
         break;
         }
@@ -111,7 +158,7 @@ void svc_c_handler(void* stk_ptr) {
             uint32_t prio = stack->r1;
             uint32_t C = stack->r2;
             uint32_t T = stack->r3;
-            void* vargp = (void*)(*(uint32_t*)((char*)stk_ptr + 0x20));
+            void* vargp = (void*)svc_stacked_args(stack, exc_return)[0];
             // printk("Argument in thread create is %p\n", vargp);
             // breakpoint();
             stack->r0 = sys_thread_create(fn, prio, C, T, vargp);
@@ -119,14 +166,26 @@ void svc_c_handler(void* stk_ptr) {
             break;
         }
 
+        case SVC_THR_CREATE_ATTR:
+            stack->r0 = sys_thread_create_attr((void*)stack->r0, stack->r1, (thread_attr_t*)stack->r2, (void*)stack->r3);
+            break;
+
         case SVC_SCHD_START:
         {
             // breakpoint();
             
             // start systick with input frequency
-            stack->r0 = sys_scheduler_start(stack->r0);
+            stack->r0 = sys_scheduler_start(stack->r0, SCHED_MODE_PERIODIC);
             break;
         }
+
+        case SVC_SCHD_START_MODE:
+            stack->r0 = sys_scheduler_start(stack->r0, stack->r1);
+            break;
+
+        case SVC_SCHED_TABLE_SET:
+            stack->r0 = sys_sched_table_set((sched_table_t*)stack->r0);
+            break;
         
         case SVC_PRIORITY:
         {
@@ -145,6 +204,63 @@ void svc_c_handler(void* stk_ptr) {
             stack->r0 = sys_thread_time();
             break;
 
+        case SVC_DELAY_MS:
+            sys_delay_ms(stack->r0);
+            break;
+
+        case SVC_SLEEP_TICKS:
+            stack->r0 = sys_sleep_ticks(stack->r0);
+            break;
+
+        case SVC_SLEEP_UNTIL:
+            stack->r0 = sys_sleep_until(stack->r0);
+            break;
+
+        case SVC_CYCLES:
+            // the DWT is privileged only, user code reads it through here
+            stack->r0 = get_cycle_count();
+            break;
+
+        case SVC_PROBE_DUMP:
+            stack->r0 = sys_probe_dump((probe_stats_t*)stack->r0, stack->r1, stack->r2);
+            break;
+
+        case SVC_GET_PID:
+            stack->r0 = sys_get_pid();
+            break;
+
+        case SVC_THR_STATS:
+            stack->r0 = sys_thread_stats(stack->r0, (thread_stats_t*)stack->r1);
+            break;
+
+        case SVC_THR_OVERRUN:
+            stack->r0 = sys_thread_overrun();
+            break;
+
+        case SVC_THR_JOIN:
+            stack->r0 = sys_thread_join(stack->r0, (int32_t*)stack->r1);
+            break;
+
+        case SVC_THR_KILL_TID:
+            stack->r0 = sys_thread_kill_tid(stack->r0);
+            break;
+
+        case SVC_THR_EXIT:
+            sys_thread_exit((int32_t)stack->r0);
+            break;
+
+        case SVC_THR_STACK_USAGE:
+            stack->r0 = sys_thread_stack_usage(stack->r0, (stack_usage_t*)stack->r1);
+            break;
+
+        case SVC_SERVER_WAIT:
+            stack->r0 = sys_server_wait();
+            break;
+
+        case SVC_SERVER_POST:
+            stack->r0 = sys_server_post(stack->r0);
+            break;
+
         case SVC_THR_KILL:
             sys_thread_kill();
             break;
@@ -158,6 +274,62 @@ void svc_c_handler(void* stk_ptr) {
             sys_mutex_unlock((kmutex_t*)stack->r0);
             break; 
 
+        case SVC_SEM_INIT:
+            stack->r0 = (uint32_t)sys_sem_init(stack->r0, stack->r1);
+            break;
+
+        case SVC_SEM_WAIT:
+            stack->r0 = sys_sem_wait((ksem_t*)stack->r0, stack->r1);
+            break;
+
+        case SVC_SEM_POST:
+            stack->r0 = sys_sem_post((ksem_t*)stack->r0);
+            break;
+
+        case SVC_EVENT_INIT:
+            stack->r0 = (uint32_t)sys_event_init();
+            break;
+
+        case SVC_EVENT_WAIT:
+            stack->r0 = sys_event_wait((kevent_t*)stack->r0, stack->r1, stack->r2, stack->r3);
+            break;
+
+        case SVC_EVENT_SET:
+            stack->r0 = sys_event_set((kevent_t*)stack->r0, stack->r1);
+            break;
+
+        case SVC_EVENT_CLEAR:
+            stack->r0 = sys_event_clear((kevent_t*)stack->r0, stack->r1);
+            break;
+
+        case SVC_MSGQ_INIT:
+            stack->r0 = (uint32_t)sys_msgq_init((void*)stack->r0, stack->r1, stack->r2);
+            break;
+
+        case SVC_MSGQ_SEND:
+            stack->r0 = sys_msgq_send((kmsgq_t*)stack->r0, (const void*)stack->r1, stack->r2);
+            break;
+
+        case SVC_MSGQ_RECV:
+            stack->r0 = sys_msgq_recv((kmsgq_t*)stack->r0, (void*)stack->r1, stack->r2);
+            break;
+
+        case SVC_MSGQ_RESERVE:
+            stack->r0 = (uint32_t)sys_msgq_reserve((kmsgq_t*)stack->r0, stack->r1);
+            break;
+
+        case SVC_MSGQ_COMMIT:
+            stack->r0 = sys_msgq_commit((kmsgq_t*)stack->r0, (void*)stack->r1);
+            break;
+
+        case SVC_MSGQ_ACQUIRE:
+            stack->r0 = (uint32_t)sys_msgq_acquire((kmsgq_t*)stack->r0, stack->r1);
+            break;
+
+        case SVC_MSGQ_RELEASE:
+            stack->r0 = sys_msgq_release((kmsgq_t*)stack->r0, (void*)stack->r1);
+            break;
+
         case READ_LUX:
             sys_read_lux();
             break;
@@ -212,4 +384,7 @@ void svc_c_handler(void* stk_ptr) {
             //breakpoint();
             break;
     }
+
+    trace_event(TRACE_SVC_EXIT, svc_num);
+    probe_exit_thread(PROBE_SVC, probe_start, probe_switch);
 }
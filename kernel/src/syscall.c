@@ -12,6 +12,7 @@
 #include<rtt.h>
 #include<printk.h>
 #include<arm.h>
+#include <syscall_thread.h>
 
 extern uint32_t* __heap_base;
 extern uint32_t* __heap_limit;
@@ -127,7 +128,12 @@ void sys_exit(int status) {
 /* syscalls for custom user projects */
 
 void sys_delay_ms(uint32_t ms) {
-    (void)ms;
+    // sleeps rather than spins, before the scheduler runs there is no tick to wake up on
+    uint32_t ticks = ticks_from_ms(ms);
+
+    if (ticks != 0) {
+        sys_sleep_ticks(ticks);
+    }
 }
 
 uint16_t sys_lux_read() {
@@ -0,0 +1,258 @@
+/** @file   syscall_msgq.c
+ *
+ *  @brief  message queues with zero copy slots
+ *
+ *  The copying send and receive are built on the zero copy calls. A thread
+ *  woken out of a wait is handed its slot by the waker through the wait
+ *  result, so a slot freed or committed for a waiter cannot be taken by a
+ *  thread which happens to run first.
+**/
+
+#include <arm.h>
+#include <printk.h>
+#include <syscall_msgq.h>
+#include <syscall_thread.h>
+
+extern volatile uint32_t currentRunningThreadID;
+
+kmsgq_t MQ[MAX_MSG_QUEUES]; // message queue pool, sized in kernel_config.h
+static uint32_t last_msgq = 0;
+
+/**
+ * 
+ * @brief Checks that a handle passed in by the user is a message queue which was handed out.
+ * 
+ * @param[in] pointer to the queue
+ * 
+ * @return 1 if valid, 0 otherwise
+ * 
+ **/
+
+static int msgq_valid(kmsgq_t* q) {
+    return (q >= &MQ[0]) && (q < &MQ[last_msgq]) && (((char*)q - (char*)MQ) % sizeof(kmsgq_t) == 0);
+}
+
+/**
+ * 
+ * @brief Returns the index of a slot pointer passed in by the user.
+ * 
+ * @param[in] pointer to the queue
+ * @param[in] pointer to the slot
+ * 
+ * @return index of the slot, -1 if it is not the start of a slot of q
+ * 
+ **/
+
+static int msgq_slot_index(kmsgq_t* q, void* slot) {
+    uint32_t offset = (uint32_t)((char*)slot - q->buf);
+
+    if (((char*)slot < q->buf) || (offset % q->slot_size) || (offset / q->slot_size >= q->slots)) {
+        return -1;
+    }
+    return (int)(offset / q->slot_size);
+}
+
+/**
+ * 
+ * @brief Reserves the next slot if the queue is not full. Interrupts must be disabled.
+ * 
+ * @param[in] pointer to the queue
+ * 
+ * @return pointer to the slot, NULL if the queue is full
+ * 
+ **/
+
+static void* msgq_take_free(kmsgq_t* q) {
+    if (q->used == q->slots) {
+        return NULL;
+    }
+
+    uint32_t slot = q->write;
+    q->write = (slot + 1 == q->slots) ? 0 : slot + 1;
+    q->used++;
+    q->reserved |= (1U << slot);
+    return q->buf + slot * q->slot_size;
+}
+
+/**
+ * 
+ * @brief Receives the oldest message if it is committed. Interrupts must be disabled.
+ * 
+ * @param[in] pointer to the queue
+ * 
+ * @return pointer to the slot, NULL if the next slot holds no message yet
+ * 
+ **/
+
+static void* msgq_take_ready(kmsgq_t* q) {
+    uint32_t slot = q->read;
+
+    if (!(q->ready & (1U << slot))) {
+        return NULL;
+    }
+
+    q->read = (slot + 1 == q->slots) ? 0 : slot + 1;
+    q->ready &= ~(1U << slot);
+    q->held |= (1U << slot);
+    return q->buf + slot * q->slot_size;
+}
+
+/**
+ * 
+ * @brief The idle thread must always be runnable, so it may not block. Main is not scheduled like
+ * the other threads, left in a wait list it would take a slot meant for one of them.
+ * 
+ * @param[in] none
+ * 
+ * @return 1 if the running thread may block
+ * 
+ **/
+
+static int may_block() {
+    return (currentRunningThreadID != IDLE_THREAD_ID) && (currentRunningThreadID != MAIN_THREAD_ID);
+}
+
+kmsgq_t* sys_msgq_init(void* buf, uint32_t slot_size, uint32_t slots) {
+    if ((buf == NULL) || (slot_size == 0) || (slots == 0) || (slots > MSGQ_MAX_SLOTS)) {
+        printk("Message queues need a buffer and 1 to %d slots\n", MSGQ_MAX_SLOTS);
+        return NULL;
+    }
+
+    if (last_msgq >= MAX_MSG_QUEUES) {
+        return NULL;
+    }
+
+    kmsgq_t* q = &MQ[last_msgq];
+    q->buf = (char*)buf;
+    q->slot_size = slot_size;
+    q->slots = slots;
+    q->used = 0;
+    q->tail = 0;
+    q->read = 0;
+    q->write = 0;
+    q->reserved = 0;
+    q->ready = 0;
+    q->held = 0;
+    q->senders = NULL;
+    q->receivers = NULL;
+    last_msgq++;
+    return q;
+}
+
+void* sys_msgq_reserve(kmsgq_t* q, uint32_t timeout) {
+    if (!msgq_valid(q)) {
+        return NULL;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    void* slot = msgq_take_free(q);
+    if ((slot != NULL) || (timeout == 0) || !may_block()) {
+        restore_interrupt_state(interrupt_status);
+        return slot;
+    }
+
+    // sys_msgq_release reserves the slot it frees for us
+    return (void*)thread_wait(&q->senders, timeout, interrupt_status);
+}
+
+int sys_msgq_commit(kmsgq_t* q, void* slot) {
+    if (!msgq_valid(q)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    int index = msgq_slot_index(q, slot);
+    if ((index < 0) || !(q->reserved & (1U << index))) {
+        restore_interrupt_state(interrupt_status);
+        return -1;
+    }
+
+    q->reserved &= ~(1U << index);
+    q->ready |= (1U << index);
+
+    // committing the oldest reserved slot may make several messages receivable at once
+    while (q->receivers != NULL) {
+        void* msg = msgq_take_ready(q);
+        if (msg == NULL) {
+            break;
+        }
+        thread_wake(q->receivers, (uint32_t)msg);
+    }
+    restore_interrupt_state(interrupt_status);
+
+    return 0;
+}
+
+void* sys_msgq_acquire(kmsgq_t* q, uint32_t timeout) {
+    if (!msgq_valid(q)) {
+        return NULL;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    void* slot = msgq_take_ready(q);
+    if ((slot != NULL) || (timeout == 0) || !may_block()) {
+        restore_interrupt_state(interrupt_status);
+        return slot;
+    }
+
+    // sys_msgq_commit receives the message for us
+    return (void*)thread_wait(&q->receivers, timeout, interrupt_status);
+}
+
+int sys_msgq_release(kmsgq_t* q, void* slot) {
+    if (!msgq_valid(q)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    int index = msgq_slot_index(q, slot);
+    if ((index < 0) || !(q->held & (1U << index))) {
+        restore_interrupt_state(interrupt_status);
+        return -1;
+    }
+
+    q->held &= ~(1U << index);
+
+    // the ring only gets space back once its oldest slot is released
+    while ((q->used != 0) && !((q->reserved | q->ready | q->held) & (1U << q->tail))) {
+        q->tail = (q->tail + 1 == q->slots) ? 0 : q->tail + 1;
+        q->used--;
+    }
+
+    while (q->senders != NULL) {
+        void* free_slot = msgq_take_free(q);
+        if (free_slot == NULL) {
+            break;
+        }
+        thread_wake(q->senders, (uint32_t)free_slot);
+    }
+    restore_interrupt_state(interrupt_status);
+
+    return 0;
+}
+
+int sys_msgq_send(kmsgq_t* q, const void* msg, uint32_t timeout) {
+    char* slot = (char*)sys_msgq_reserve(q, timeout);
+
+    if (slot == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < q->slot_size; i++) {
+        slot[i] = ((const char*)msg)[i];
+    }
+    return sys_msgq_commit(q, slot);
+}
+
+int sys_msgq_recv(kmsgq_t* q, void* msg, uint32_t timeout) {
+    char* slot = (char*)sys_msgq_acquire(q, timeout);
+
+    if (slot == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < q->slot_size; i++) {
+        ((char*)msg)[i] = slot[i];
+    }
+    return sys_msgq_release(q, slot);
+}
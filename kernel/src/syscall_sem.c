@@ -0,0 +1,226 @@
+/** @file   syscall_sem.c
+ *
+ *  @brief  counting semaphores and event flag groups
+ *
+ *  Both keep their waiters in a priority ordered wait queue and block them
+ *  through thread_wait, which also handles the timeouts. Posting and setting
+ *  flags only wake threads and pend a PendSV, so they are safe from
+ *  interrupt handlers.
+**/
+
+#include <arm.h>
+#include <printk.h>
+#include <syscall_sem.h>
+#include <syscall_thread.h>
+
+extern tcb_t TCB[NUM_TCBS];
+extern volatile uint32_t currentRunningThreadID;
+
+ksem_t SEM[MAX_SEMAPHORES]; // semaphore pool, sized in kernel_config.h
+kevent_t EVT[MAX_EVENT_GROUPS]; // event group pool, sized in kernel_config.h
+static uint32_t last_sem = 0;
+static uint32_t last_event = 0;
+
+/**
+ * 
+ * @brief Checks that a handle passed in by the user is a semaphore which was handed out.
+ * 
+ * @param[in] pointer to the semaphore
+ * 
+ * @return 1 if valid, 0 otherwise
+ * 
+ **/
+
+static int sem_valid(ksem_t* sem) {
+    return (sem >= &SEM[0]) && (sem < &SEM[last_sem]) && (((char*)sem - (char*)SEM) % sizeof(ksem_t) == 0);
+}
+
+/**
+ * 
+ * @brief Checks that a handle passed in by the user is an event group which was handed out.
+ * 
+ * @param[in] pointer to the event group
+ * 
+ * @return 1 if valid, 0 otherwise
+ * 
+ **/
+
+static int event_valid(kevent_t* event) {
+    return (event >= &EVT[0]) && (event < &EVT[last_event]) && (((char*)event - (char*)EVT) % sizeof(kevent_t) == 0);
+}
+
+/**
+ * 
+ * @brief Returns the flags which satisfy a waiter, 0 if it has to keep waiting.
+ * 
+ * @param[in] currently set flags
+ * @param[in] flags waited for
+ * @param[in] EVENT_WAIT_* options
+ * 
+ * @return the flags of mask which are set, 0 if that is not enough
+ * 
+ **/
+
+static uint32_t event_match(uint32_t flags, uint32_t mask, uint32_t options) {
+    uint32_t match = flags & mask;
+
+    if ((options & EVENT_WAIT_ALL) && (match != mask)) {
+        return 0;
+    }
+    return match;
+}
+
+/**
+ * 
+ * @brief The idle thread must always be runnable, so it may not block. Main is not scheduled like
+ * the other threads, left in a wait list it would take a post meant for one of them.
+ * 
+ * @param[in] none
+ * 
+ * @return 1 if the running thread may block
+ * 
+ **/
+
+static int may_block() {
+    return (currentRunningThreadID != IDLE_THREAD_ID) && (currentRunningThreadID != MAIN_THREAD_ID);
+}
+
+ksem_t* sys_sem_init(uint32_t count, uint32_t max) {
+    if ((max == 0) || (count > max)) {
+        printk("Semaphore count must be at most max, max at least 1\n");
+        return NULL;
+    }
+
+    if (last_sem >= MAX_SEMAPHORES) {
+        return NULL;
+    }
+
+    ksem_t* sem = &SEM[last_sem];
+    sem->count = count;
+    sem->max = max;
+    sem->waiters = NULL;
+    last_sem++;
+    return sem;
+}
+
+int sys_sem_wait(ksem_t* sem, uint32_t timeout) {
+    if (!sem_valid(sem)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if (sem->count != 0) {
+        sem->count--;
+        restore_interrupt_state(interrupt_status);
+        return 0;
+    }
+
+    if ((timeout == 0) || !may_block()) {
+        restore_interrupt_state(interrupt_status);
+        return -1;
+    }
+
+    // a post hands its unit straight over, the count is not touched again here
+    return thread_wait(&sem->waiters, timeout, interrupt_status) ? 0 : -1;
+}
+
+int sys_sem_post(ksem_t* sem) {
+    int ret = 0;
+
+    if (!sem_valid(sem)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if (sem->waiters != NULL) {
+        thread_wake(sem->waiters, 1);
+    }
+    else if (sem->count < sem->max) {
+        sem->count++;
+    }
+    else {
+        ret = -1;
+    }
+    restore_interrupt_state(interrupt_status);
+
+    return ret;
+}
+
+kevent_t* sys_event_init() {
+    if (last_event >= MAX_EVENT_GROUPS) {
+        return NULL;
+    }
+
+    kevent_t* event = &EVT[last_event];
+    event->flags = 0;
+    event->waiters = NULL;
+    last_event++;
+    return event;
+}
+
+uint32_t sys_event_wait(kevent_t* event, uint32_t mask, uint32_t options, uint32_t timeout) {
+    if (!event_valid(event) || (mask == 0)) {
+        return 0;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    uint32_t match = event_match(event->flags, mask, options);
+    if (match) {
+        if (options & EVENT_WAIT_CLEAR) {
+            event->flags &= ~match;
+        }
+        restore_interrupt_state(interrupt_status);
+        return match;
+    }
+
+    if ((timeout == 0) || !may_block()) {
+        restore_interrupt_state(interrupt_status);
+        return 0;
+    }
+
+    tcb_t* self = &TCB[currentRunningThreadID];
+    self->wait_mask = mask;
+    self->wait_options = options;
+
+    // sys_event_set evaluates the wait and clears the flags for us
+    return thread_wait(&event->waiters, timeout, interrupt_status);
+}
+
+int sys_event_set(kevent_t* event, uint32_t flags) {
+    if (!event_valid(event)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    event->flags |= flags;
+
+    // in priority order, so a higher priority waiter consumes cleared flags first
+    tcb_t* waiter = event->waiters;
+    while (waiter != NULL) {
+        tcb_t* next = waiter->wait_next;
+        uint32_t match = event_match(event->flags, waiter->wait_mask, waiter->wait_options);
+
+        if (match) {
+            if (waiter->wait_options & EVENT_WAIT_CLEAR) {
+                event->flags &= ~match;
+            }
+            thread_wake(waiter, match);
+        }
+        waiter = next;
+    }
+    restore_interrupt_state(interrupt_status);
+
+    return 0;
+}
+
+int sys_event_clear(kevent_t* event, uint32_t flags) {
+    if (!event_valid(event)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    event->flags &= ~flags;
+    restore_interrupt_state(interrupt_status);
+
+    return 0;
+}
@@ -1,1182 +1,3511 @@
-/** @file   syscall_thread.c
- *
- *  @brief  thread syscall implementation for lab 4
- *  @note   Not for public release, do not share
- *
- *  @date   last modified 14 October 2022
- *  @author CMU 14-642
-**/
-
-#include <arm.h>
-#include <mpu.h>
-#include <printk.h>
-#include <syscall.h>
-#include <syscall_mutex.h>
-#include <syscall_thread.h>
-#include <unistd.h>
-#include <timer.h>
-#include<i2c.h>
-#include<gpio.h>
-#include<adc.h>
-#include<pix.h>
-
-/** @brief      Initial XPSR value, all 0s except thumb bit. */
-#define XPSR_INIT 0x1000000
-
-/** @brief Return code to return to user mode with user stack.*/
-#define LR_RETURN_TO_USER_PSP 0xFFFFFFFD
-
-extern uint32_t* __thread_k_stacks_base; // 0x20018000
-extern uint32_t* __thread_k_stacks_limit; // 0x20010000
-extern uint32_t* __thread_u_stacks_base; // 0x20010000
-extern uint32_t* __thread_u_stacks_limit; // 0x20008000
-extern char* __psp_stack_limit;
-extern char* __msp_stack_limit;
-
-
-/** @brief thread stack region limits */
-//extern char __thread_u_stacks_limit, __thread_k_stacks_limit, __thread_k_stacks_base, __thread_u_stacks_base;
-
-/** @brief precomputed values for UB test */
-float ub_table[] = {
-    0.000, 1.000, .8284, .7798, .7568,
-     .7435, .7348, .7286, .7241, .7205,
-     .7177, .7155, .7136, .7119, .7106,
-     .7094, .7083, .7075, .7066, .7059,
-     .7052, .7047, .7042, .7037, .7033,
-     .7028, .7025, .7021, .7018, .7015,
-     .7012, .7009
-};
-
-tcb_t TCB[16]; // array of 16 TCBs
-kmutex_t MU[32]; // array of 32 mutexes
-int last_mutex=0;
-
-uint32_t eachThread;
-// TCB 0 is main thread
-// TCB 15 is the idle thread
-
-
-// global tracker to track position in tcb
-tcb_t* idle_tcb_pointers[16] = {0}; // pointer to the TCBs
-// static int threadsCreated = -1;
-static uint8_t totalThreads = 1;
-uint32_t max_threads_from_user = 0;
-uint32_t max_mutexes = 0;
-// uint32_t systemTime = 0; //global system time counter
-volatile uint32_t currentRunningThreadID = 0;
-volatile uint32_t nextThreadID = 1;
-uint32_t global_system_time = 0;
-static uint32_t invocations = 0;
-volatile uint32_t available_mutexes; // maximum number of mutexes available in the system
-tcb_t* free_tcb_list = NULL;
-kmutex_t* free_mutex_list; // free list containing mutexes
-int kernel_mode_set = 0;
-kmutex_t* global_mutex_list = NULL; // this is the global linked list storing all the mutexes in the system at the moment
-// volatile kmutex_t * highest_priority_ceiling_m = NULL;
-
-void default_idle();
-void tcb_init(tcb_t* tcb, void* fn, void* vargp, uint32_t priority, uint32_t C, uint32_t T);
-void append_tcb_list(tcb_t** start, tcb_t* new_tcb);
-tcb_t* get_first_tcb(tcb_t** start);
-void thread_kill_working();
-void default_idle_helper();
-void print_tcb(tcb_t* tcb_list);
-
-/**
- * 
- * @brief This function is used to handle the interrupts which are generated by the systick timer
- * We perform the necessary state changes and then pend the pend SV which will take care of the
- * scheduling of the threads.
- * 
- * @param[in] none
- * 
- * @return does not return any value 
- * 
- **/
-
-
-void systick_c_handler() {
-    ++global_system_time; // increment global system time counter
-    //printk("systick is working\n"); 
-    pend_pendsv();
-
-    for(int i = 1; i < 15; i++) {
-        if(TCB[i].state != STOPPED) {
-            if(((TCB[i].state == RUNNING)) || ((global_system_time != 0) && ((global_system_time % (TCB[i].T)) == 0))) {
-                TCB[i].state = RUNNABLE;
-        }
-        }
-    }
-
-        TCB[currentRunningThreadID].execution_time++;
-        // TCB[currentRunningThreadID].time_since_scheduler_start += TCB[currentRunningThreadID].execution_time;
-        TCB[currentRunningThreadID].time_since_scheduler_start++;
-
-
-    // update the status of the other tasks in the system
-    return;
-}
-
-/**
- * 
- * This is the pendsv C handler which is going to take care of scheduling the next highest prio 
- * thread ID in the system. This accepts a pointer to the msp of the task which is stored in the 
- * stack and it will be transferred into r0 in the asm handler before the control being passed
- * into this very c handler. This does the necessary scheduling and then passes control back into the 
- * pend the pendsv asm handler.
- * 
- * @param[in] pointer to the msp
- * 
- * @return does not return 
- * 
- **/
-
-void *pendsv_c_handler(void *msp){
-    // in Systick handler, the next thread to be scheduled will be updated
-    // check for that thread and schedule it here 
-
-    // breakpoint();
-    clear_pendsv();
-
-    msp_stack_frame_t* ptr = (msp_stack_frame_t*)msp;
-
-    // we are going to run the RMS scheduler 
-    nextThreadID = RMS(); // RMS choice - returns with min period
-    
-    if (nextThreadID == 0) {
-      // stop systick timer here
-	systick_stop();
-    }
-
-
-    if((nextThreadID == currentRunningThreadID) && (TCB[currentRunningThreadID].state != BLOCKED) && (TCB[currentRunningThreadID].state != STOPPED)){
-        // return the same msp
-        TCB[currentRunningThreadID].state = RUNNING;
-        // printk("Scheduling thread %lu\n", currentRunningThreadID);
-        return msp;
-    }
-
-    // if there are no threads left to run in the pool
-    if(currentRunningThreadID != nextThreadID) {
-
-        
-        // breakpoint();
-        // means a different thread needs to be scheduled, save the context
-
-        TCB[currentRunningThreadID].msp = ptr; // save the ptr
-            
-        TCB[currentRunningThreadID].svc_status = get_svc_status();
-
-        uint8_t size = mm_log2ceil_size(eachThread);
-        if (nextThreadID == 0) {
-                size = mm_log2ceil_size(2048);
-        }
-
-        if(!kernel_mode_set) {
-            if (currentRunningThreadID != 0) {
-                mm_region_disable(USER_REGION);
-            }
-            if (mm_region_enable(USER_REGION, TCB[nextThreadID].user_stack_start, size, 0, 1) != 0) {
-                 printk("Enable USER_REGION mem protection failed for thread id = %d\n", nextThreadID);
-            }
-        }
-        if (currentRunningThreadID != 0) mm_region_disable(KERNEL_REGION);
-        if (mm_region_enable(KERNEL_REGION, TCB[nextThreadID].kernel_stack_start, size, 0, 1) != 0) {
-            printk("Enable KERNEL_REGION mem protection failed for thread id = %d\n", nextThreadID);
-        }
-            
-    }
-    
-        // schedule the next thread
-        TCB[nextThreadID].state = RUNNING;
-
-        currentRunningThreadID = nextThreadID;
-
-        set_svc_status(TCB[currentRunningThreadID].svc_status);
-
-        //printk("Scheduling thread %lu\n", currentRunningThreadID);
-
-        return (void*)TCB[nextThreadID].msp;
-}
-
-/**
- * 
- * 
- * @brief This is the default idle thread function which acts as a helper to call the wait_for_interrupt
- * function. When no threads remain in the system, then this idle thread is scheduled to run.
- * 
- * @params[in] none
- * 
- * @return does not return 
- * 
- **/
-
-void default_idle_helper()
-{
-	//default_idle();
-        while (1) {
- 		wait_for_interrupt();
-	}
-}
-
-/**
- * 
- * @brief This function is used to append an new mutex into the linked list of mutexes. It takes in
- * a pointer to the start of the list and also a pointer to the new mutex which must be added into
- * the linked list.
- * 
- * @param[in] pointer to the start of the linked list
- * @param[in] pointer to the mutex which needs to be added into the list
- * 
- * @return does not return 
- * 
- */
-
-void append_mutex_list(kmutex_t** start, kmutex_t* new_mutex) {
-    return;
-        if (*start == NULL) {
-                new_mutex->next = NULL;
-                *start = new_mutex;
-                return;
-        }
-        kmutex_t* node = *start;
-        while (node->next != NULL) {
-                node = node->next;
-        }
-        new_mutex->next = NULL;
-        node->next = new_mutex;
-}
-
-/**
- * 
- * This function is used to append a new tcb into the linked list of TCBs that we maintain
- * in our kernel. This takes in a pointer to the start of the linked list and a pointer to the
- * new tcb which needs to be added.
- * 
- * @param[in] start of the tcb linked list
- * @param[in] pointer to the new tcb
- * 
- * @return does not return 
- * 
- **/
-
-
-void append_tcb_list(tcb_t** start, tcb_t* new_tcb) {
-	if (*start == NULL) {
-        new_tcb->next = NULL;
-		*start = new_tcb;
-		return;
-	}
-    tcb_t* node = *start;
-	while (node->next != NULL) {
-        // printk("Node is %p\n", node);
-		node = node->next;
-	}
-
-    if(new_tcb != node) {
-    new_tcb->next = NULL;
-    node->next = new_tcb;       
-    }
-
-}
-
-/**
- * 
- * @brief This function is used to delete a tcb from the linked list of the TCBs. It also takes a pointer 
- * to the tcb which has to be deleted from the linked list. 
- * 
- * @params[in] pointer to the linked list from which the tcb has to be deleted
- * @params[in] pointer to the tcb which has to be deleted from the linked list
- * 
- * @return does not return 
- * 
- **/
-
-
-void delete_tcb(tcb_t** start, tcb_t* del_tcb) {
-	if (*start == NULL) {
-		return;
-	}
-	// if del_tcb is first node in list
-	if (*start == del_tcb) {
-		*start = del_tcb->next;
-        del_tcb->next = NULL;
-		return;
-	}
-	tcb_t* node = *start;
-        while (node->next != del_tcb) {
-                node = node->next;
-        }
-        if (node != *start) {
-        	node->next = del_tcb->next;
-            del_tcb->next = NULL;
-	}
-}
-
-/**
- * 
- * @brief This function is used to delete a mutex from the linked list of the mutexes. It also takes a pointer 
- * to the mutex which has to be deleted from the linked list. 
- * 
- * @params[in] pointer to the linked list from which the mutex has to be deleted
- * @params[in] pointer to the mutex which has to be deleted from the linked list
- * 
- * @return does not return 
- * 
- **/
-
-void delete_mutex(kmutex_t** start, kmutex_t* del_mutex) {
-    return;
-	if (*start == NULL) {
-		return;
-	}
-	// if del_tcb is first node in list
-	if (*start == del_mutex) {
-		*start = del_mutex->next;
-        del_mutex->next = NULL;
-		return;
-	}
-	kmutex_t* node = *start;
-        while (node->next != del_mutex) {
-                node = node->next;
-        }
-        if (node != *start) {
-        	node->next = del_mutex->next;
-            del_mutex->next = NULL;
-	}
-}
-
-/**
- * 
- * @brief This is the function that is used to get the first free tcb from the linked list of TCBs.
- * It takes in a pointer to the tcb which needs to be deleted.
- * 
- * @params[in] pointer to tcb which has to be deleted from the list
- * 
- * @return returns a pointer to the tcb which has been fetched from the linked list
- * 
- **/
-
-tcb_t* get_first_tcb(tcb_t** start) {
-        tcb_t* first = *start;
-	if (first == NULL) {
-		printk("freelist is empty\n");
-                return NULL;
-        }
-	if (first->next == NULL) {
-                //printk("failed to make second tcb\n");
-		*start = NULL;
-        first->next = NULL;
-        return first;
-	}
-	else {
-		tcb_t* result = first;
-		*start = first->next;
-		result->next = NULL;
-		return result;
-	}
-}
-
-/**
- * 
- * @brief We maintain a free list of mutexes. This function loops through the free list
- * and returns the next free mutex.
- * 
- * @param[in] Pointer to the start of the linked list of mutexes from where we need to fetch the mutex
- * from 
- * .
- * 
- * @return Returns a pointer to the mutex which has been fetched from the linked list of the mutexes.
- * 
- */
-
-
-kmutex_t* get_first_mutex(kmutex_t** start) {
-        kmutex_t* first = *start;
-        if (first == NULL) {
-                printk("freelist of kmutex_t is empty\n");
-                return NULL;
-        }
-        if (first->next == NULL) {
-                //printk("failed to make second kmutex_t\n");
-                *start = NULL;
-                first->next = NULL;
-                return first;
-        }
-        else {
-                kmutex_t* result = first;
-                *start = first->next;
-                result->next = NULL;
-                return result;
-        }
-}
-
-/**
- * 
- * @brief This is the system call that is used to initialise the threads of the system. This takes
- * in all the details from the user like maximum threads to be created, size of the stack for each
- * thread, pointer to the idle function, mode of memory protection and the maximum mutexes needed.
- * 
- * @param[in] maximum number of threads of the system
- * @param[in] stack size for each thread
- * @param[in] pointer to the idle function
- * @param[in] memory protection - kernel only or per thread protection
- * @param[in] maximum number of mutexes in the system
- * 
- * @return -1 on failure and 0 on success
- * 
- **/
-
-
-int sys_thread_init(uint32_t max_threads, uint32_t stack_size, void* idle_fn, mpu_mode memory_protection, uint32_t user_max_mutexes) {
-
-   int interrupt_status = save_interrupt_state_and_disable();
-
-   if (idle_fn == NULL) {
-       idle_fn = &default_idle;
-    }
-    max_mutexes = user_max_mutexes;
-
-    //enable the FPU to perform floating point operations
-    enable_fpu();
-
-    max_threads_from_user = max_threads;
-
-    uint32_t log = mm_log2ceil_size(stack_size * 4);
-    
-    eachThread = (1U << log);
-
-    uint32_t total_size = max_threads * eachThread;
-    
-    if((total_size > ((uint32_t)(&__thread_k_stacks_base) - (uint32_t)(&__thread_k_stacks_limit))) || 
-        (total_size > ((uint32_t)(&__thread_u_stacks_base) - (uint32_t)(&__thread_u_stacks_limit)))) {
-            printk("Stack is oversized bro, reduce it\n");
-            restore_interrupt_state(interrupt_status);
-            return -1;
-        }
-    // initialise the stack data structures
-    
-    if(!memory_protection) {
-        kernel_mode_set = 1;
-        mm_region_enable(USER_REGION, (void*)&__thread_u_stacks_limit, mm_log2ceil_size(32768), 0, 1);
-    }
-
-    // offset by stack_size * 4 cos we are using char* in pointer arithmetic not uint32_t* 
-    
-    uint32_t offset = eachThread;
-
-    for(uint32_t i = 0; i < max_threads; i++) {
-        // breakpoint();
-        offset = (i * eachThread);
-        TCB[i+1].kernel_stack_start = (void*)((char*)&__thread_k_stacks_limit + offset);
-        TCB[i+1].kernel_stack_end = (void*)((char*)TCB[i+1].kernel_stack_start + eachThread);
-        TCB[i+1].user_stack_start = (void*)((char*)&__thread_u_stacks_limit + offset);
-        TCB[i+1].user_stack_end = (void*)((char*)TCB[i+1].user_stack_start + eachThread);
-        TCB[i+1].fn = idle_fn;
-        TCB[i+1].next = NULL;
-      	append_tcb_list(&free_tcb_list, &TCB[i+1]); 
-        TCB[i+1].state = STOPPED;
-   } 
-    // initialized free mutex list
-    for (uint32_t i = 0; i < max_mutexes; i++) {
-        MU[i].owner = NULL;
-        MU[i].locked_by = __UINT32_MAX__;
-        //append_mutex_list(&free_mutex_list, &MU[i]);
-    }
-    available_mutexes = max_mutexes;
-    // main already has msp and psp initialized do not waste stack region for this
-    TCB[0].msp->lr = (void*)LR_RETURN_TO_USER_PSP;
-    TCB[0].prio = max_threads;
-    TCB[0].msp->psp->xPSR = XPSR_INIT;
-    TCB[0].svc_status = 0;
-    TCB[0].kernel_stack_start = (void*)& __msp_stack_limit;
-    TCB[0].user_stack_start = (void*)& __psp_stack_limit;
-
-    // initialise idle thread TCB
-    
-    TCB[15].kernel_stack_end = &__thread_k_stacks_base;
-    TCB[15].kernel_stack_start = (void*)((char*)TCB[15].kernel_stack_end - eachThread);
-
-    TCB[15].user_stack_end = &__thread_u_stacks_base;
-    TCB[15].user_stack_start = (void*)((char*)TCB[15].user_stack_end - eachThread);
-
-
-    TCB[15].msp = (msp_stack_frame_t*)((char*)TCB[15].kernel_stack_end - sizeof(msp_stack_frame_t));
-    TCB[15].msp->psp = (interrupt_stack_frame*)((char*)TCB[15].user_stack_end - sizeof(interrupt_stack_frame));
-    // TCB[15].msp->psp->r0 = (uint32_t)vargp;
-
-    TCB[15].msp->lr = (void*)LR_RETURN_TO_USER_PSP;
-    TCB[15].prio = __UINT32_MAX__;
-    TCB[15].msp->psp->xPSR = XPSR_INIT;
-    TCB[15].svc_status = 0;
-    TCB[15].C = __UINT32_MAX__;
-    TCB[15].T = __UINT32_MAX__;
-    TCB[15].state = RUNNABLE;
-    TCB[15].running_time = 0;
-    TCB[15].execution_time = 0;
-
-    TCB[15].msp->psp->pc = idle_fn;
-    TCB[15].msp->psp->lr = &default_idle;
-    TCB[15].msp->psp->xPSR = XPSR_INIT;
-    // setting everything to 0 so that all registers are clear when first init happens
-    TCB[15].msp->psp->r1 = 0;
-    TCB[15].msp->psp->r2 = 0;
-    TCB[15].msp->psp->r3 = 0;
-    TCB[15].msp->psp->r12 = 0;
-    TCB[15].msp->r4 = 0;
-    TCB[15].msp->r5 = 0;
-    TCB[15].msp->r6 = 0;
-    TCB[15].msp->r7 = 0;
-    TCB[15].msp->r8 = 0;
-    TCB[15].msp->r9 = 0;
-    TCB[15].msp->r10 = 0;
-    TCB[15].msp->r11 = 0;
-    TCB[15].running_time = 0;
-    TCB[15].svc_status = 0;
-    TCB[15].execution_time = 0;
-    TCB[15].static_priority = __UINT8_MAX__;
-    TCB[15].time_since_scheduler_start = 0;
-    
-    restore_interrupt_state(interrupt_status);
-    return 0;
-}
-
-/** @brief create a new thread as specified, if UB allows
- *
- *  @param fn       thread function pointer
- *  @param prio     thread priority, with 0 being highest
- *  @param C        execution time (scheduler ticks)
- *  @param T        task period (scheduler ticks)
- *  @param vargp    thread function argument
- *
- *  @return     0 for success, -1 for failure
- */
-
-int sys_thread_create(void* fn, uint32_t priority, uint32_t C, uint32_t T, void* vargp) {
-
-    // printk("Thread has priority %lu and Period %lu\n", priority, T);
-   
-    
-    if(priority > 14) {
-        printk("Prio cannot be greater than 15\n");
-        return -1;
-    }
-
-    if(totalThreads > max_threads_from_user) {
-        printk("Exceeded thread limit, %u, max threads is %u\n", totalThreads, max_threads_from_user);
-        return -1;
-    }
-
-    // As soon as the user requests for a new thread, run a UB test for RMS to see if we can accept the thread
-    if(UB_test_RMS(totalThreads, C, T) == -1) {
-        printk("UB test failed\n");
-        return -1;
-    }
-    //breakpoint();   
-    // find empty TCB
-    tcb_t* tcb = get_first_tcb(&free_tcb_list);
-    //printk("Got tcb %p\n", tcb);
-    if (tcb == NULL) {
-        printk("No free TCB\n");
-        return -1;
-    } 
-    tcb->next = NULL;
-    tcb_init(tcb, fn, vargp, priority, C, T);
-    totalThreads++;
-
-    invocations++; // successfully created 
-
-    tcb->state = RUNNABLE;
-
-    // printk("Successfully created %u threads \n", invocations);
-    return 0;
-}
-
-/**
- * 
- * @brief We maintain a linked list of all the TCBs. This function is used to initialise the linked 
- * list of the TCBs. It takes in the same paramters as sys_thread create and then assigns it to
- * the individual fields in the TCB.
- * 
- * @param fn       thread function pointer
- * @param prio     thread priority, with 0 being highest
- * @param C        execution time (scheduler ticks)
- * @param T        task period (scheduler ticks)
- * @param vargp    thread function argument
- * 
- * @return     0 for success, -1 for failure
- * 
- **/
-
-void tcb_init(tcb_t* tcb, void* fn, void* vargp, uint32_t priority, uint32_t C, uint32_t T) {
-    //breakpoint();
-    tcb->msp = (msp_stack_frame_t*)((char*)tcb->kernel_stack_end - sizeof(msp_stack_frame_t));
-    tcb->msp->lr = (void*)LR_RETURN_TO_USER_PSP;
-    tcb->prio = priority;
-    tcb->state = STOPPED;
-    tcb->msp->psp = (interrupt_stack_frame*)((char*)tcb->user_stack_end - sizeof(interrupt_stack_frame));
-    //printk("stack is %p \n", tcb->msp->psp);
-    tcb->msp->psp->r0 = (uint32_t)(vargp);
-    //printk("Argument in sys thread create is %s\n",tcb->msp->psp->r0);
-    tcb->msp->psp->pc = fn;
-    tcb->msp->psp->lr = (void*)&thread_kill_working;
-    tcb->msp->psp->xPSR = XPSR_INIT;
-    // setting everything to 0 so that all registers are clear when first init happens
-    tcb->msp->psp->r1 = 0;
-    tcb->msp->psp->r2 = 0;
-    tcb->msp->psp->r3 = 0;
-    tcb->msp->psp->r12 = 0;
-    tcb->msp->r4 = 0;
-    tcb->msp->r5 = 0;
-    tcb->msp->r6 = 0;
-    tcb->msp->r7 = 0;
-    tcb->msp->r8 = 0;
-    tcb->msp->r9 = 0;
-    tcb->msp->r10 = 0;
-    tcb->msp->r11 = 0;
-    tcb->running_time = 0;
-    tcb->C = C; // assign C
-    tcb->T = T; // assign T
-    tcb->svc_status = 0;
-    tcb->execution_time = 0;
-    tcb->static_priority = priority;
-    tcb->dynamic_priority = priority;
-    tcb->time_since_scheduler_start = 0;
-    tcb->acquired_mutexes = NULL;
-}
-
-/** @brief tell the kernel to start running threads using Systick
- *  @note  returns only after all threads complete or are killed
- *
- *  @param frequency  frequncy of context switches in Hz
- *
- *  @return     0 for success, -1 for failure
- */
-
-int sys_scheduler_start(uint32_t frequency) {
-    systick_start(frequency);
-    pend_pendsv();
-    return 0;
-}
-
-/** @brief get the dynamic priority of the running thread 
- * 
- * @param no input paramters
- * 
- * @return returns the priority of the thread
- * 
- **/
-
-uint32_t sys_get_priority() {
-    return TCB[currentRunningThreadID].dynamic_priority;
-}
-
-/** @brief get the current time in ticks 
- * 
- * @param no input parameters
- * 
- * @return global system time which is mainted by the system
- * 
- **/
-
-uint32_t sys_get_time() {
-    return global_system_time;
-}
-
-/** @brief get the total elapsed time for the running thread 
- * 
- * @param no input parameters
- * 
- * @return value cumulative time that the thread has been executing
- * 
- **/
-
-uint32_t sys_thread_time() {
-    return TCB[currentRunningThreadID].time_since_scheduler_start;
-}
-
-/** @brief kill the running thread
- *
- *  @note  locks if main or idle thread is running or thread holds a mutex
- *
- *  @return does not return
- */
-
-void print_tcb(tcb_t* tcb_list) {
-    tcb_t* temp = tcb_list;
-
-    while(temp != NULL) {
-        printk("%p=>", temp);
-        temp = temp->next;
-    }
-}
-
-void sys_thread_kill() {
-    printk("Killing the thread %lu\n", currentRunningThreadID);
-    // tcb_t* free_tcb = NULL;
-    if ((currentRunningThreadID != 0) && (currentRunningThreadID != 15)) {
-        TCB[currentRunningThreadID].state = STOPPED;
-        TCB[currentRunningThreadID].next = NULL;
-        TCB[currentRunningThreadID].execution_time = 0;
-
-        // free_tcb = &TCB[currentRunningThreadID];
-        // free_tcb->next = NULL;
-        append_tcb_list(&free_tcb_list, &TCB[currentRunningThreadID]);
-        if(totalThreads > 1) {
-            totalThreads--;
-        }
-    }
-    
-    // if currentRunningThreadID = 0, call sysexit
-    if (currentRunningThreadID == 0) {
-        // call sysexit here
-        // systick_stop();
-        sys_exit(0);
-    }
-    pend_pendsv();
-    // if currentRunningThreadID = 15, call default_idle, psp->lr for idle thread is set to default_idle
-}
-
-/** @brief deschedule thread and wait until next turn 
- * 
- * @param no input parameters
- * 
- * @return no return value
- * 
- **/
-
-
-void sys_wait_until_next_period() {
-    // set the thread to waiting then immediately pend
-    // a PendSV to run the scheduler. This will swap the thread out immediately, without waiting for the next SysTick.
-    // make current thread waiting state
-    // make scheduler wait till next interrupt
-    TCB[currentRunningThreadID].state = WAITING;
-    TCB[currentRunningThreadID].execution_time = 0;
-    TCB[currentRunningThreadID].svc_status = 0;
-    pend_pendsv(); 
-    wait_for_interrupt();
-}
-
-/**
- * 
- * @brief This function is used to initialise  mutex in the system. It accepts the max prio
- * ceiling of the thread that will be using it. The kernel will not be doing any kind
- * of checking in this function.
- * 
- * @param in max prio of the thread that will use the mutex
- * 
- * @return pointer to the mutex on success and NULL on failure
- * 
- **/
-
-
-kmutex_t* sys_mutex_init(uint32_t max_prio) {
-    MU[last_mutex].locked_by = __UINT32_MAX__;
-    MU[last_mutex].prio_ceil = max_prio;
-    MU[last_mutex].owner = NULL;
-    return &MU[last_mutex++];
-}
-
-
-kmutex_t* find_highest_priority_ceiling() {
-    uint32_t res = __UINT32_MAX__;
-    kmutex_t* m=NULL;
-    // while(temp != NULL) {
-    for(int i = 0 ; i < last_mutex; i ++)
-    {
-        kmutex_t* temp = &MU[i];
-        if(temp->prio_ceil < res && temp->owner != NULL) {
-            res = temp->prio_ceil;
-            m=temp;
-        }
-
-        // temp = temp->next;
-    }
-
-    if(res!=__UINT32_MAX__)
-        return m;
-    else    
-        return NULL;
-}
-/**
- * 
- * @brief this function is used to lock a mutex when a thread has to execute a critical section.
- * 
- * @param takes in a pointer to the mutex that the thread wants to lock
- * 
- * @return no return value
- * 
- **/
-
-
-void sys_mutex_lock(kmutex_t* mutex) {
-
-    uint32_t thread_holding_previous_lock;
-
-    if(TCB[currentRunningThreadID].static_priority < mutex->prio_ceil) {
-        // printk("You cannot acquire this mutex dear thread, you are of low priority.!\n");
-        sys_thread_kill();
-    }
-
-    if (mutex->owner == &TCB[currentRunningThreadID]) {
-        printk("WARNING (sys_mutex_lock): Lock already acquired by the same thread %lu\n", currentRunningThreadID - 1);
-        return;
-    }
-     
-        
-        kmutex_t* highest_priority_ceiling_m = find_highest_priority_ceiling();
-
-    
-
-        while((highest_priority_ceiling_m!= NULL) 
-        && (TCB[currentRunningThreadID].dynamic_priority >= highest_priority_ceiling_m->prio_ceil) 
-        && (highest_priority_ceiling_m->owner != &TCB[currentRunningThreadID])
-        ){
-            // this means that the currentRunningThread has highest prio amongst all resources
-            thread_holding_previous_lock = mutex->locked_by;
-            
-            TCB[currentRunningThreadID].state = BLOCKED; // prev holding task becomes BLOCKED now
-
-            if(TCB[thread_holding_previous_lock].dynamic_priority > TCB[currentRunningThreadID].static_priority)
-                TCB[thread_holding_previous_lock].dynamic_priority = TCB[currentRunningThreadID].static_priority;
-            
-            
-            pend_pendsv();
-            
-            highest_priority_ceiling_m = find_highest_priority_ceiling();
-
-        }        
-
-    //printk("Got the lock(%p) by thread %lu\n",mutex, currentRunningThreadID);
-    
-    mutex->owner = &TCB[currentRunningThreadID];
-    mutex->locked_by = currentRunningThreadID;
-
-    return;
-}
-
-/**
- * 
- * @brief this function is used to unlock a mutex when a thread is done executing a critical section.
- * 
- * @param takes in a pointer to the mutex that the thread wants to unlock
- * 
- * @return no return value
- * 
- **/
-
-void sys_mutex_unlock(kmutex_t* mutex) {
-    if (mutex->owner == NULL) {
-        printk("WARNING (sys_mutex_unlock): Mutex is free, cannot be unlocked again\n");
-        // pend_pendsv();
-    }
-    else
-        TCB[mutex->locked_by].dynamic_priority = TCB[mutex->locked_by].static_priority;
-
-
-    // check in the mutex list
-
-    // delete_mutex(&TCB[currentRunningThreadID].acquired_mutexes, mutex);
-    mutex->next = NULL;
-
-    //TODO : Now once a mutex has been released by a task, then should we wait for all the mutexes 
-    // held by this task to be released? Or can we proceed with scheduling the next one?
-
-    mutex->owner = NULL;
-    mutex->locked_by = __UINT32_MAX__;
-
-    //printk("Unlocked the lock(%p) by thread %lu\n",mutex, currentRunningThreadID);
-
-
-    for(int i = 1; i <= 14; i++) {
-        if(TCB[i].state == BLOCKED) {
-            TCB[i].state = RUNNABLE;
-        }
-    }
-
-    // TCB[currentRunningThreadID].dynamic_priority = TCB[currentRunningThreadID].static_priority;
-    // pend_pendsv();
-    //append_mutex_list(free_mutex_list, mutex);
-}
-
-/**
- * 
- * @brief RMS scheduler which is used to find the highest priority task based on the time period
- * of each task.
- * 
- * @param[in] none
- * 
- * @return returns the ID of the thread 
- * 
- **/
-
-uint32_t RMS() {
-    uint32_t stopped = 0;
-    for(uint32_t i = 1; i <= max_threads_from_user; i++) {
-        if (TCB[i].state == STOPPED) {
-            stopped++;
-	    continue;
-        }
-        // if ((global_system_time != 0) && ((global_system_time % (TCB[i].T)) == 0)) {
-        //     // if (((global_system_time % (TCB[i].T)) == 0)) {
-        // // if ((global_system_time != 0) && ((global_system_time % (TCB[i].T - 1)) == 0)) {
-        //     // one edge case here is that, if currentThreadID just changed to waiting, but period has been
-        //     // reached, then the state immediately changes to RUNNABLE
-        //     TCB[i].state = RUNNABLE;
-        // }
-    }
-
-    
-   
-
-    if((TCB[currentRunningThreadID].state != BLOCKED) && (TCB[currentRunningThreadID].state != STOPPED) &&
-        ((TCB[currentRunningThreadID].execution_time >= TCB[currentRunningThreadID].C) 
-            || (TCB[currentRunningThreadID].state == WAITING))) {
-        // TODO : print a warning message if the thread is currently holding a mutex
-        TCB[currentRunningThreadID].dynamic_priority = TCB[currentRunningThreadID].static_priority;
-        TCB[currentRunningThreadID].state = WAITING;
-        TCB[currentRunningThreadID].execution_time = 0;
-    }
-
-
-    if (stopped == max_threads_from_user) {
-	// schedule main if all threads died
-        return 0;
-    } 
-
-    // find the task with the least period
-    uint32_t min_period = __UINT32_MAX__;
-    uint32_t index = 15;
-
-
-    for(uint32_t i = 1; i <= max_threads_from_user; i++) {
-        // if((TCB[i].dynamic_priority < min_period) && (TCB[i].state == RUNNABLE)) {
-        //     min_period = TCB[i].dynamic_priority;
-        //     index = i;
-        // }
-        if( TCB[i].state == RUNNABLE && TCB[i].state != STOPPED) {
-            if(TCB[i].dynamic_priority <= min_period){
-                min_period = TCB[i].dynamic_priority;
-                index = i;
-            }
-            else if(TCB[i].dynamic_priority == min_period && TCB[i].dynamic_priority != TCB[i].static_priority)
-            {
-                index = i;
-            }
-
-            
-        }
-    }
-
-    // printk("The next highest priority task is %lu\n", index);
-
-    return index;
-
-}
-
-/**
- * 
- * @brief Used to perform the UB test and outputs whether the task set is schedulable or not
- * 
- * @param[in] Number of threads in the system currently (includes the new thread to be scheduled)
- * @param[in] WCET of the task
- * @param[in] Time period of the task 
- * 
- * */
-
-int UB_test_RMS(uint32_t no_threads, uint32_t C, uint32_t T) {
-    // uint32_t index = no_threads - 1;
-
-    if(no_threads == 0) {
-        no_threads = 1;
-    }
-
-    float Ci = (float)C;
-    float Ti = (float)T;
-
-    if(no_threads == 1) {
-        // first thread is being created 
-
-        if((Ci / Ti) > ub_table[no_threads]) {
-            return -1;
-        }
-    }
-
-    float util = 0.0f;
-
-    for(uint32_t i = 1; i < no_threads; i++) {
-        util += (float)((float)(TCB[i].C) / (float)(TCB[i].T));
-    }
-
-    if((util + (Ci / Ti)) > ub_table[no_threads]) {
-        return -1;
-    }
-
-    return 0;
-
-}
-
-/**
- * 
- * @brief This function is used to read the lux sensor. This is a system call which gets
- * called when the stub for the specific user function is pressed. 
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_read_lux() {
-    // printk("entered read lux\n");
-
-    uint8_t txbuffer1[3] = {0x00, 0x00, 0x00};
-
-	int i2c;
-	i2c = i2c_leader_write(txbuffer1, 3, 0x10);
-
-	i2c_leader_stop();
-
-	if(i2c == -1) {
-		printk("Write failed\n");
-	}
-
-	uint8_t txbuffer2[1]= {0x04};
-
-	i2c = i2c_leader_write(txbuffer2, 1, 0x10);
-
-	if(i2c == -1) {
-		printk("Write failed\n");
-	}
-
-	uint8_t rxbuffer[2] = {0};
-
-	int i2c_ = i2c_leader_read(rxbuffer, 2, 0x10);
-
-	i2c_leader_stop();
-	if(i2c_ == -1) {
-		printk("Read failed\n");
-	}
-
-	uint16_t result_ = 0;
-    (void)result_;
-    result_ = rxbuffer[0] | (rxbuffer[1] << 8);
-
-    // printk("I read %d from lux\n", result_);
-}
-
-/**
- * 
- * @brief This function is used to read the microphone. This is a system call which gets
- * called when the stub for the specific user function is pressed. 
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_read_mic() {
-    // printk("entered mic lux\n");
-    adc_read_pin();
-}
-
-/**
- * 
- * @brief This function is system call which is used to glow the led. This is called
- * via a stub from the user space function.
- * 
- * @param[in] If the user gives 0 then the leds turn off. Else, then remain on.
- * 
- * @return none
- * 
- */
-
-void sys_glow_led(int on) {
-    glow_led(on);
-}
-
-
-/**
- * 
- * @brief This function is used to move the car forward. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_move_forward(void) {
-    pwm_actuate_forward();
-}
-
-
-/**
- * 
- * @brief This function is used to move the car backward. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_move_backward(void) {
-
-    pwm_actuate_backward();
-}
-
-
-/**
- * 
- * @brief This function is used to move the car left. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_turn_left(void) {
-
-    pwm_actuate_left();
-}
-
-
-/**
- * 
- * @brief This function is used to move the car right. This is the system call that does
- * the propulsion. It calls another pwm helper function to actuate the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_turn_right(void) {
-    pwm_actuate_right();
-}
-
-
-/**
- * 
- * @brief This function is used to stop the car. It calls another pwm helper function to stop the motors.
- * 
- * @params[in] none
- * 
- * @return none
- * 
- */
-
-void sys_stop_car(void) {
-    pwm_stop();
-}
-
-
+/** @file   syscall_thread.c
+ *
+ *  @brief  thread syscall implementation for lab 4
+ *  @note   Not for public release, do not share
+ *
+ *  @date   last modified 14 October 2022
+ *  @author CMU 14-642
+**/
+
+#include <arm.h>
+#include <mpu.h>
+#include <printk.h>
+#include <syscall.h>
+#include <syscall_mutex.h>
+#include <syscall_thread.h>
+#include <unistd.h>
+#include <timer.h>
+#include <stack_alloc.h>
+#include <probe.h>
+#include <trace.h>
+#include<i2c.h>
+#include<gpio.h>
+#include<adc.h>
+#include<pix.h>
+#include<rtt.h>
+
+/** @brief      Initial XPSR value, all 0s except thumb bit. */
+#define XPSR_INIT 0x1000000
+
+/** @brief Return code to return to user mode with user stack.*/
+#define LR_RETURN_TO_USER_PSP 0xFFFFFFFD
+
+extern uint32_t* __thread_k_stacks_base; // 0x20018000
+extern uint32_t* __thread_k_stacks_limit; // 0x20010000
+extern uint32_t* __thread_u_stacks_base; // 0x20010000
+extern uint32_t* __thread_u_stacks_limit; // 0x20008000
+extern char* __psp_stack_limit;
+extern char* __msp_stack_limit;
+
+
+/** @brief thread stack region limits */
+//extern char __thread_u_stacks_limit, __thread_k_stacks_limit, __thread_k_stacks_base, __thread_u_stacks_base;
+
+/** @brief 1.0 in the Q32 fixed point of the admission tests, which keep the FPU out of SVCs */
+#define Q32_ONE (1ULL << 32)
+
+/** @brief the Liu and Layland bound n(2^(1/n) - 1) for n threads in Q32, rounded down */
+static const uint64_t ub_table[] = {
+    0, 4294967296ULL, 3558067406ULL, 3349057225ULL,
+    3250553483ULL, 3193272857ULL, 3155822953ULL, 3129427398ULL,
+    3109822013ULL, 3094685641ULL, 3082646742ULL, 3072842871ULL,
+    3064704546ULL, 3057840595ULL, 3051973441ULL, 3046900661ULL,
+    3042471160ULL, 3038569879ULL, 3035107652ULL, 3032014313ULL,
+    3029233890ULL, 3026721190ULL, 3024439321ULL, 3022357873ULL,
+    3020451553ULL, 3018699150ULL, 3017082748ULL, 3015587105ULL,
+    3014199178ULL, 3012907734ULL, 3011703050ULL, 3010576668ULL
+};
+
+/** @brief the limit of the bound, ln 2 in Q32 rounded down, for more threads than ub_table covers */
+#define UB_LN2 2977044470ULL
+
+tcb_t TCB[NUM_TCBS]; // user threads plus main and idle, sized in kernel_config.h
+kmutex_t MU[MAX_MUTEXES]; // mutex pool, sized in kernel_config.h
+int last_mutex=0;
+
+// user and kernel stacks are carved out of the two linker stack regions per thread
+static stack_pool_t user_stack_pool;
+static stack_pool_t kernel_stack_pool;
+// stack size in bytes of threads created without one
+static uint32_t default_stack_size;
+// TCB 0 is main thread
+// TCB IDLE_THREAD_ID (the last one) is the idle thread
+
+
+// global tracker to track position in tcb
+tcb_t* idle_tcb_pointers[NUM_TCBS] = {0}; // pointer to the TCBs
+// static int threadsCreated = -1;
+static uint8_t totalThreads = 1;
+uint32_t max_threads_from_user = 0;
+uint32_t max_mutexes = 0;
+// uint32_t systemTime = 0; //global system time counter
+volatile uint32_t currentRunningThreadID = 0;
+volatile uint32_t nextThreadID = 1;
+uint32_t global_system_time = 0;
+static uint32_t invocations = 0;
+volatile uint32_t available_mutexes; // maximum number of mutexes available in the system
+tcb_t* free_tcb_list = NULL;
+static tcb_t* free_tcb_tail = NULL; // last tcb of free_tcb_list, freed tcbs are reused oldest first
+kmutex_t* free_mutex_list; // free list containing mutexes
+int kernel_mode_set = 0;
+kmutex_t* global_mutex_list = NULL; // this is the global linked list storing all the mutexes in the system at the moment
+// volatile kmutex_t * highest_priority_ceiling_m = NULL;
+
+// ready bitmap, bit (31 - p % 32) of word p / 32 is set while priority level p has a RUNNABLE
+// or RUNNING thread, bit (31 - w) of ready_group is set while word w is non zero. The highest
+// ready priority level is two clz away for any number of levels
+static uint32_t ready_group = 0;
+static uint32_t ready_bitmap[NUM_PRIO_WORDS];
+static tcb_t* ready_head[NUM_PRIO_LEVELS]; // FIFO of ready threads for every priority level
+static tcb_t* ready_tail[NUM_PRIO_LEVELS];
+static uint32_t live_threads = 0; // number of user threads which are not STOPPED
+static ktimer_t* release_queue = NULL; // next release of every live thread, earliest first
+static uint32_t sched_policy = SCHED_POLICY_RMS;
+static tcb_t* edf_ready = NULL; // ready threads sorted by absolute deadline, used instead of the bitmap under EDF
+static tcb_t* console_server = NULL; // sporadic server which is signalled on console input
+static ktimer_t* timeout_queue = NULL; // timeouts of the semaphore and event waits, earliest first
+
+// system ceiling, the same two level bitmap as the ready bitmap over the ceilings of the locked
+// mutexes. Each level keeps its locked mutexes most recently locked first, the head of the
+// highest level is the mutex which sets the system ceiling
+static uint32_t ceiling_group = 0;
+static uint32_t ceiling_bitmap[NUM_PRIO_WORDS];
+static kmutex_t* ceiling_head[NUM_PRIO_LEVELS];
+
+/** @brief timing of one task in the response time analysis */
+typedef struct {
+    uint32_t prio;
+    uint32_t C;
+    uint32_t T;
+    uint32_t D;
+} rta_task_t;
+
+// admission, sums over the live threads of C / T and C / D in Q32, each term rounded up. Kept
+// as threads are created and killed so that the utilization tests are O(1)
+static uint64_t util_sum = 0;
+static uint64_t density_sum = 0;
+static uint32_t constrained_threads = 0; // live threads with D < T
+static uint32_t rm_inversions = 0; // pairs of live threads with equal or not rate monotonic priorities
+static uint32_t admission_epoch = 0; // changes of the live set, a create whose test saw an older epoch tests again
+
+// tickless mode, the scheduler runs off a one shot timer instead of a periodic SysTick
+static uint32_t tickless = 0;
+static uint32_t counts_per_tick = 0; // one shot timer counts per scheduler tick
+static uint32_t tickless_max_ticks = 0; // longest one shot interval
+static uint32_t tick_start_count = 0; // one shot timer count at which the current tick started
+static uint32_t sched_frequency = 0; // scheduler ticks per second, 0 until the scheduler starts
+
+// budget accounting, the running thread is charged in DWT cycles whenever the scheduler runs
+static uint32_t cycles_per_tick = 0; // cycles in one scheduler tick, a job's budget is C of them
+static uint32_t charged_at = 0; // cycle count up to which the running thread has been charged
+
+// stack scan, every stack is walked up from its lowest word to its high water mark while idle
+static uint32_t scan_tid = 1; // thread whose stacks are being scanned
+static uint32_t scan_kernel = 0; // set while its kernel stack is being scanned
+static uint32_t* scan_at = NULL; // next word to check
+
+/** @brief word painted over every thread stack when it is allocated */
+#define STACK_PAINT 0xA5A5A5A5
+/** @brief most stack words checked every time the PendSV picks the idle thread */
+#define STACK_SCAN_WORDS 32
+
+/** @brief priority level of a job which runs on after an overrun, kept free of user threads */
+#define BACKGROUND_PRIORITY (NUM_PRIO_LEVELS - 1)
+/** @brief EDF only, how far the deadline of such a job is moved, behind every other deadline */
+#define BACKGROUND_DEADLINE 0x7FFFFFFF
+
+// table mode, the tick releases the threads of the schedule table instead of the release queue
+static sched_table_t sched_table;
+static uint32_t table_loaded = 0; // sched_table holds a table, admission tests are skipped
+static uint32_t table_admitted = 0; // a thread skipped the tests, only table mode may start
+static uint32_t table_mode = 0; // set while the threads run from sched_table
+static uint32_t table_frame = 0; // current minor frame
+static uint32_t table_frame_left = 0; // ticks to the end of the current minor frame
+static uint32_t table_slot = 0; // first slot of the current minor frame whose job is not done
+
+void default_idle();
+void tcb_init(tcb_t* tcb, void* fn, void* vargp, uint32_t priority, uint32_t C, uint32_t T);
+kmutex_t* find_highest_priority_ceiling();
+static uint8_t thread_base_priority(tcb_t* tcb);
+void append_tcb_list(tcb_t** start, tcb_t* new_tcb);
+tcb_t* get_first_tcb(tcb_t** start);
+void thread_kill_working();
+void default_idle_helper();
+void print_tcb(tcb_t* tcb_list);
+
+/**
+ * 
+ * @brief EDF only. Links a tcb into the deadline ordered ready list, after any thread with the
+ * same deadline.
+ * 
+ * @param[in] pointer to the tcb
+ * 
+ * @return none
+ * 
+ **/
+
+static void edf_ready_insert(tcb_t* tcb) {
+    tcb_t* prev = NULL;
+    tcb_t* node = edf_ready;
+
+    // wrap safe comparison, same as the timer queues
+    while ((node != NULL) && ((int32_t)(node->deadline - tcb->deadline) <= 0)) {
+        prev = node;
+        node = node->rq_next;
+    }
+
+    tcb->rq_prev = prev;
+    tcb->rq_next = node;
+    if (node != NULL) {
+        node->rq_prev = tcb;
+    }
+    if (prev != NULL) {
+        prev->rq_next = tcb;
+    }
+    else {
+        edf_ready = tcb;
+    }
+
+    tcb->in_ready = 1;
+}
+
+/**
+ * 
+ * @brief Links a tcb at the tail (or head) of the ready list of its dynamic priority and marks
+ * the level as ready in the ready bitmap. Threads outside the bitmap range are never scheduled
+ * through it (main and idle are handled by RMS directly).
+ * 
+ * @param[in] pointer to the tcb
+ * @param[in] non zero to link the tcb at the head of the list
+ * 
+ * @return none
+ * 
+ **/
+
+static void ready_insert(tcb_t* tcb, int at_head) {
+    uint32_t level = tcb->dynamic_priority;
+
+    if (tcb->in_ready) {
+        return;
+    }
+
+    if (sched_policy == SCHED_POLICY_EDF) {
+        edf_ready_insert(tcb);
+        return;
+    }
+
+    if (level >= NUM_PRIO_LEVELS) {
+        return;
+    }
+
+    if (ready_head[level] == NULL) {
+        tcb->rq_next = NULL;
+        tcb->rq_prev = NULL;
+        ready_head[level] = tcb;
+        ready_tail[level] = tcb;
+    }
+    else if (at_head) {
+        tcb->rq_prev = NULL;
+        tcb->rq_next = ready_head[level];
+        ready_head[level]->rq_prev = tcb;
+        ready_head[level] = tcb;
+    }
+    else {
+        tcb->rq_next = NULL;
+        tcb->rq_prev = ready_tail[level];
+        ready_tail[level]->rq_next = tcb;
+        ready_tail[level] = tcb;
+    }
+
+    ready_bitmap[level >> 5] |= (1U << (31 - (level & 31)));
+    ready_group |= (1U << (31 - (level >> 5)));
+    tcb->in_ready = 1;
+}
+
+/**
+ * 
+ * @brief Unlinks a tcb from the ready list of its dynamic priority, the level is cleared in
+ * the ready bitmap once its list is empty.
+ * 
+ * @param[in] pointer to the tcb
+ * 
+ * @return none
+ * 
+ **/
+
+static void ready_remove(tcb_t* tcb) {
+    uint32_t level = tcb->dynamic_priority;
+
+    if (!tcb->in_ready) {
+        return;
+    }
+
+    if (tcb->rq_prev != NULL) {
+        tcb->rq_prev->rq_next = tcb->rq_next;
+    }
+    else if (sched_policy == SCHED_POLICY_EDF) {
+        edf_ready = tcb->rq_next;
+    }
+    else {
+        ready_head[level] = tcb->rq_next;
+    }
+
+    if (tcb->rq_next != NULL) {
+        tcb->rq_next->rq_prev = tcb->rq_prev;
+    }
+    else if (sched_policy != SCHED_POLICY_EDF) {
+        ready_tail[level] = tcb->rq_prev;
+    }
+
+    if ((sched_policy != SCHED_POLICY_EDF) && (ready_head[level] == NULL)) {
+        ready_bitmap[level >> 5] &= ~(1U << (31 - (level & 31)));
+        if (ready_bitmap[level >> 5] == 0) {
+            ready_group &= ~(1U << (31 - (level >> 5)));
+        }
+    }
+
+    tcb->rq_next = NULL;
+    tcb->rq_prev = NULL;
+    tcb->in_ready = 0;
+}
+
+/**
+ * 
+ * @brief Clears the timing statistics of a thread.
+ * 
+ * @param[in] pointer to the statistics
+ * 
+ * @return none
+ * 
+ **/
+
+static void stats_reset(thread_stats_t* stats) {
+    uint32_t* word = (uint32_t*)stats;
+
+    for (uint32_t i = 0; i < (sizeof(thread_stats_t) / sizeof(uint32_t)); i++) {
+        word[i] = 0;
+    }
+
+    stats->response_min = __UINT32_MAX__;
+    stats->latency_min = __UINT32_MAX__;
+}
+
+/**
+ * 
+ * @brief Starts a new job of a thread. A job which is still active at the next release has
+ * missed its deadline, since D <= T.
+ * 
+ * @param[in] pointer to the tcb
+ * @param[in] release time of the job
+ * 
+ * @return none
+ * 
+ **/
+
+static void stats_job_release(tcb_t* tcb, uint32_t released_at) {
+    if (tcb->job_active) {
+        tcb->stats.deadline_misses++;
+    }
+
+    tcb->job_release = released_at;
+    tcb->job_active = 1;
+    tcb->job_started = 0;
+}
+
+/**
+ * 
+ * @brief Records the release latency of a job when it is dispatched for the first time.
+ * 
+ * @param[in] pointer to the tcb
+ * 
+ * @return none
+ * 
+ **/
+
+static void stats_job_start(tcb_t* tcb) {
+    if (!tcb->job_active || tcb->job_started) {
+        return;
+    }
+
+    uint32_t latency = global_system_time - tcb->job_release;
+
+    tcb->job_started = 1;
+    if (latency < tcb->stats.latency_min) tcb->stats.latency_min = latency;
+    if (latency > tcb->stats.latency_max) tcb->stats.latency_max = latency;
+}
+
+/**
+ * 
+ * @brief Records the response time of a job when it completes.
+ * 
+ * @param[in] pointer to the tcb
+ * @param[in] non zero if the job was stopped because it ran out of budget
+ * 
+ * @return none
+ * 
+ **/
+
+static void stats_job_end(tcb_t* tcb, int overrun) {
+    if (!tcb->job_active) {
+        return;
+    }
+
+    uint32_t response = global_system_time - tcb->job_release;
+    uint32_t bucket = (response == 0) ? 0 : (32 - count_leading_zeros(response));
+
+    if (bucket >= STATS_HIST_BUCKETS) {
+        bucket = STATS_HIST_BUCKETS - 1;
+    }
+
+    tcb->job_active = 0;
+    tcb->stats.jobs++;
+    tcb->stats.response_total += response;
+    if (response < tcb->stats.response_min) tcb->stats.response_min = response;
+    if (response > tcb->stats.response_max) tcb->stats.response_max = response;
+    tcb->stats.hist[bucket]++;
+
+    if (overrun) {
+        tcb->stats.overruns++;
+    }
+    if (response > tcb->D) {
+        tcb->stats.deadline_misses++;
+    }
+}
+
+/**
+ * 
+ * @brief Sporadic server only. Makes the server ready and starts the window whose consumed
+ * budget is replenished one period later.
+ * 
+ * @param[in] pointer to the tcb of the server
+ * 
+ * @return none
+ * 
+ **/
+
+static void server_activate(tcb_t* tcb) {
+    tcb->server.active = 1;
+    tcb->server.activated = global_system_time;
+    tcb->server.consumed = 0;
+    thread_set_state(tcb, RUNNABLE);
+}
+
+/**
+ * 
+ * @brief Sporadic server only. Ends the active window and schedules the replenishment of the
+ * budget consumed in it. When all the replenishment slots are in use the amount is merged
+ * into the latest one, which only gives it back later than necessary.
+ * 
+ * @param[in] pointer to the tcb of the server
+ * 
+ * @return none
+ * 
+ **/
+
+static void server_deactivate(tcb_t* tcb) {
+    server_t* server = &tcb->server;
+
+    if (!server->active) {
+        return;
+    }
+
+    server->active = 0;
+
+    if (server->consumed == 0) {
+        return;
+    }
+
+    if (server->repl_count == SERVER_MAX_REPLENISHMENTS) {
+        uint8_t last = (server->repl_head + server->repl_count - 1) % SERVER_MAX_REPLENISHMENTS;
+        server->repl_amount[last] += server->consumed;
+        server->repl_at[last] = server->activated + tcb->T;
+    }
+    else {
+        uint8_t slot = (server->repl_head + server->repl_count) % SERVER_MAX_REPLENISHMENTS;
+        server->repl_at[slot] = server->activated + tcb->T;
+        server->repl_amount[slot] = server->consumed;
+        server->repl_count++;
+
+        if (server->repl_count == 1) {
+            // the release timer of a server tracks its earliest replenishment
+            tcb->release_timer.expires = server->repl_at[slot];
+            timer_queue_insert(&release_queue, &tcb->release_timer);
+        }
+    }
+
+    server->consumed = 0;
+}
+
+/**
+ * 
+ * @brief Sporadic server only. Called from the tick when the earliest replenishment is due,
+ * gives the budget back and resumes the server if it still has work.
+ * 
+ * @param[in] pointer to the tcb of the server
+ * 
+ * @return none
+ * 
+ **/
+
+static void server_replenish(tcb_t* tcb) {
+    server_t* server = &tcb->server;
+
+    server->budget += server->repl_amount[server->repl_head];
+    if (server->budget > tcb->C) {
+        server->budget = tcb->C;
+    }
+
+    server->repl_head = (server->repl_head + 1) % SERVER_MAX_REPLENISHMENTS;
+    server->repl_count--;
+
+    if (server->repl_count != 0) {
+        tcb->release_timer.expires = server->repl_at[server->repl_head];
+        timer_queue_insert(&release_queue, &tcb->release_timer);
+    }
+
+    if ((tcb->state == WAITING) && !server->idle && !server->active && (server->budget != 0)) {
+        server_activate(tcb);
+    }
+}
+
+/**
+ * 
+ * @brief Sporadic server only. Records an event, an idle server is woken if it has budget
+ * left, otherwise at its next replenishment.
+ * 
+ * @param[in] pointer to the tcb of the server
+ * @param[in] SERVER_EVENT_* bit
+ * 
+ * @return none
+ * 
+ **/
+
+static void server_signal(tcb_t* tcb, uint32_t event) {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    tcb->server.pending |= event;
+
+    if (tcb->server.idle) {
+        tcb->server.idle = 0;
+        // the response time of a server job is measured from the event
+        stats_job_release(tcb, global_system_time);
+        if (tcb->server.budget != 0) {
+            server_activate(tcb);
+        }
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+void thread_set_state(tcb_t* tcb, state_t state) {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    state_t old_state = tcb->state;
+    tcb->state = state;
+
+    if ((state == RUNNABLE) && ((old_state == BLOCKED) || (old_state == SLEEPING))) {
+        trace_thread_event(TRACE_UNBLOCK, tcb - TCB, 0);
+    }
+    else if ((state != old_state) && (state != RUNNABLE) && (state != RUNNING)) {
+        trace_thread_event(TRACE_BLOCK, tcb - TCB, state);
+    }
+
+    if ((tcb != &TCB[MAIN_THREAD_ID]) && (tcb != &TCB[IDLE_THREAD_ID])) {
+        if ((state == RUNNABLE) || (state == RUNNING)) {
+            ready_insert(tcb, 0);
+            if (tickless && (state == RUNNABLE)) {
+                // no periodic tick is coming to run the scheduler
+                pend_pendsv();
+            }
+        }
+        else {
+            ready_remove(tcb);
+        }
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief Adds a mutex which has just been locked to the system ceiling.
+ * 
+ * @param[in] pointer to the mutex
+ * 
+ * @return none
+ * 
+ **/
+
+static void ceiling_push(kmutex_t* mutex) {
+    uint32_t level = mutex->prio_ceil;
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    mutex->prev = NULL;
+    mutex->next = ceiling_head[level];
+    if (mutex->next != NULL) {
+        mutex->next->prev = mutex;
+    }
+    ceiling_head[level] = mutex;
+
+    ceiling_bitmap[level >> 5] |= (1U << (31 - (level & 31)));
+    ceiling_group |= (1U << (31 - (level >> 5)));
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief Removes a mutex which is being unlocked from the system ceiling.
+ * 
+ * @param[in] pointer to the mutex
+ * 
+ * @return none
+ * 
+ **/
+
+static void ceiling_pop(kmutex_t* mutex) {
+    uint32_t level = mutex->prio_ceil;
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if (mutex->prev != NULL) {
+        mutex->prev->next = mutex->next;
+    }
+    else {
+        ceiling_head[level] = mutex->next;
+    }
+    if (mutex->next != NULL) {
+        mutex->next->prev = mutex->prev;
+    }
+    mutex->next = NULL;
+    mutex->prev = NULL;
+
+    if (ceiling_head[level] == NULL) {
+        ceiling_bitmap[level >> 5] &= ~(1U << (31 - (level & 31)));
+        if (ceiling_bitmap[level >> 5] == 0) {
+            ceiling_group &= ~(1U << (31 - (level >> 5)));
+        }
+    }
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief Queues a thread on the mutex which sets the ceiling blocking it, after every waiter
+ * of the same or higher dynamic priority.
+ * 
+ * @param[in] pointer to the mutex
+ * @param[in] pointer to the tcb of the waiter
+ * 
+ * @return none
+ * 
+ **/
+
+static void mutex_wait_insert(kmutex_t* mutex, tcb_t* tcb) {
+    wait_queue_insert(&mutex->waiting_threads, tcb);
+}
+
+/**
+ * 
+ * @brief Requeues the waiters an unlock handed over to a thread along with the mutex, in
+ * priority order. Waiters the current ceiling still blocks join the queue of the ceiling mutex,
+ * the first one which could get past it is woken and inherits the rest of the list, so at most
+ * one waiter is woken at a time.
+ * 
+ * @param[in] pointer to the tcb holding the handed over waiters
+ * 
+ * @return none
+ * 
+ **/
+
+static void mutex_requeue_handoff(tcb_t* tcb) {
+    int interrupt_status = save_interrupt_state_and_disable();
+    tcb_t* waiter = tcb->handoff;
+
+    tcb->handoff = NULL;
+    while (waiter != NULL) {
+        tcb_t* rest = waiter->wait_next;
+        kmutex_t* ceiling_m = find_highest_priority_ceiling();
+
+        waiter->wait_next = NULL;
+        if ((ceiling_m != NULL) && (waiter->dynamic_priority >= ceiling_m->prio_ceil) && (ceiling_m->owner != waiter)) {
+            mutex_wait_insert(ceiling_m, waiter);
+            // the ceiling owner inherits the priority of the threads it blocks, as on lock
+            if (ceiling_m->owner->dynamic_priority > waiter->dynamic_priority) {
+                thread_set_dynamic_priority(ceiling_m->owner, waiter->dynamic_priority);
+            }
+        }
+        else {
+            waiter->handoff = rest;
+            thread_set_state(waiter, RUNNABLE);
+            break;
+        }
+        waiter = rest;
+    }
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief Frees a locked mutex and hands it over to its highest priority waiter, which takes the
+ * rest of the queue along and requeues it once it runs. Interrupts disabled.
+ * 
+ * @param[in] pointer to the mutex
+ * 
+ * @return the waiter which was made runnable, NULL if there was none
+ * 
+ **/
+
+static tcb_t* mutex_hand_over(kmutex_t* mutex) {
+    tcb_t* waiter = mutex->waiting_threads;
+
+    // nested sections unlock in reverse order, the mutex is almost always first in the list
+    kmutex_t** link = &mutex->owner->acquired_mutexes;
+    while (*link != mutex) {
+        link = &(*link)->owned_next;
+    }
+    *link = mutex->owned_next;
+    mutex->owned_next = NULL;
+
+    ceiling_pop(mutex);
+    mutex->owner = NULL;
+    mutex->locked_by = __UINT32_MAX__;
+    mutex->waiting_threads = NULL;
+    if (waiter != NULL) {
+        waiter->handoff = waiter->wait_next;
+        waiter->wait_next = NULL;
+        thread_set_state(waiter, RUNNABLE);
+    }
+
+    return waiter;
+}
+
+/**
+ * 
+ * @brief Priority a thread runs at once it unlocked a mutex, its base priority raised to that of
+ * the highest priority waiter of every mutex it still holds. O(mutexes held), interrupts
+ * disabled.
+ * 
+ * @param[in] pointer to the tcb
+ * 
+ * @return the dynamic priority
+ * 
+ **/
+
+static uint8_t mutex_owner_priority(tcb_t* tcb) {
+    uint8_t prio = thread_base_priority(tcb);
+
+    // wait queues are kept in priority order, the first waiter of each mutex is enough
+    for (kmutex_t* mutex = tcb->acquired_mutexes; mutex != NULL; mutex = mutex->owned_next) {
+        if ((mutex->waiting_threads != NULL) && (mutex->waiting_threads->dynamic_priority < prio)) {
+            prio = mutex->waiting_threads->dynamic_priority;
+        }
+    }
+
+    return prio;
+}
+
+/**
+ * 
+ * @brief Takes a blocked mutex waiter out of the queue of the mutex it waits on, or out of the
+ * list an unlock handed over to another waiter, and drops the priority the owner inherited from
+ * it. O(mutexes + threads), for kills only, interrupts disabled.
+ * 
+ * @param[in] pointer to the tcb of the waiter
+ * 
+ * @return none
+ * 
+ **/
+
+static void mutex_wait_remove(tcb_t* tcb) {
+    for (int i = 0; i < last_mutex; i++) {
+        tcb_t** link = &MU[i].waiting_threads;
+
+        while ((*link != NULL) && (*link != tcb)) {
+            link = &(*link)->wait_next;
+        }
+        if (*link == tcb) {
+            *link = tcb->wait_next;
+            tcb->wait_next = NULL;
+            if (MU[i].owner != NULL) {
+                thread_set_dynamic_priority(MU[i].owner, mutex_owner_priority(MU[i].owner));
+            }
+            return;
+        }
+    }
+
+    for (uint32_t i = 0; i < NUM_TCBS; i++) {
+        tcb_t** link = &TCB[i].handoff;
+
+        while ((*link != NULL) && (*link != tcb)) {
+            link = &(*link)->wait_next;
+        }
+        if (*link == tcb) {
+            *link = tcb->wait_next;
+            tcb->wait_next = NULL;
+            return;
+        }
+    }
+}
+
+/**
+ * 
+ * @brief Paints a new stack so that the stack scan can tell the words which were written.
+ * 
+ * @param[in] lowest address of the stack
+ * @param[in] one past the highest address of the stack
+ * 
+ * @return none
+ * 
+ **/
+
+static void stack_paint(void* start, void* end) {
+    for (uint32_t* word = (uint32_t*)start; word < (uint32_t*)end; word++) {
+        *word = STACK_PAINT;
+    }
+}
+
+/**
+ * 
+ * @brief Idle time only. Checks the next few words of the stack scan, which walks the user and
+ * then the kernel stack of every live thread and of idle up from the lowest word. The first word
+ * which is no longer paint is the new high water mark and the scan moves on to the next stack.
+ * Stacks grow down, so only the part of a stack below its mark is ever walked, and the threads
+ * are all switched out while idle runs.
+ * 
+ * @param[in] none
+ * 
+ * @return none
+ * 
+ **/
+
+static void stack_scan_step() {
+    uint32_t words = STACK_SCAN_WORDS;
+    uint32_t stacks = 0;
+
+    while (words != 0) {
+        tcb_t* tcb = &TCB[scan_tid];
+        uint32_t** mark = scan_kernel ? &tcb->kernel_stack_mark : &tcb->user_stack_mark;
+        uint32_t* start = (uint32_t*)(scan_kernel ? tcb->kernel_stack_start : tcb->user_stack_start);
+
+        if ((tcb->state == STOPPED) || (scan_at < start) || (scan_at >= *mark)) {
+            // every stack is looked at most once per call, the marks may all be settled
+            if (++stacks > 2 * NUM_TCBS) {
+                return;
+            }
+            scan_kernel = !scan_kernel;
+            if (!scan_kernel) {
+                scan_tid = (scan_tid == IDLE_THREAD_ID) ? 1 : (scan_tid + 1);
+            }
+            scan_at = (uint32_t*)(scan_kernel ? TCB[scan_tid].kernel_stack_start : TCB[scan_tid].user_stack_start);
+            continue;
+        }
+
+        if (*scan_at != STACK_PAINT) {
+            *mark = scan_at;
+        }
+        else {
+            scan_at++;
+        }
+        words--;
+    }
+}
+
+/**
+ * 
+ * @brief Allocates the user and kernel stacks of a thread, both of the same size and so
+ * covered by the same MPU region size and sub-region mask, which are cached in the tcb.
+ * 
+ * @param[in] pointer to the tcb of the thread
+ * @param[in] size of each stack in bytes
+ * 
+ * @return 0 on success and -1 if either pool is out of room
+ * 
+ **/
+
+static int thread_stacks_alloc(tcb_t* tcb, uint32_t size) {
+    stack_block_t user;
+    stack_block_t kernel;
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if (stack_pool_alloc(&user_stack_pool, size, &user) != 0) {
+        restore_interrupt_state(interrupt_status);
+        return -1;
+    }
+    if (stack_pool_alloc(&kernel_stack_pool, size, &kernel) != 0) {
+        stack_pool_free(&user_stack_pool, user.start, user.end);
+        restore_interrupt_state(interrupt_status);
+        return -1;
+    }
+
+    tcb->user_stack_start = user.start;
+    tcb->user_stack_end = user.end;
+    tcb->kernel_stack_start = kernel.start;
+    tcb->kernel_stack_end = kernel.end;
+    tcb->stack_log2 = user.region_log2;
+    tcb->stack_srd = user.srd;
+
+    // nothing of the new stacks is used yet. A scan which stopped part way through the stacks of
+    // a killed thread in this tcb would resume in the middle of the new ones, it moves on instead
+    tcb->user_stack_mark = (uint32_t*)user.end;
+    tcb->kernel_stack_mark = (uint32_t*)kernel.end;
+    if (scan_tid == (uint32_t)(tcb - TCB)) {
+        scan_at = NULL;
+    }
+    restore_interrupt_state(interrupt_status);
+
+    stack_paint(tcb->user_stack_start, tcb->user_stack_end);
+    stack_paint(tcb->kernel_stack_start, tcb->kernel_stack_end);
+    return 0;
+}
+
+/**
+ * 
+ * @brief Gives the stacks of a thread back to the pools.
+ * 
+ * @param[in] pointer to the tcb of the thread
+ * 
+ * @return none
+ * 
+ **/
+
+static void thread_stacks_free(tcb_t* tcb) {
+    int interrupt_status = save_interrupt_state_and_disable();
+    stack_pool_free(&user_stack_pool, tcb->user_stack_start, tcb->user_stack_end);
+    stack_pool_free(&kernel_stack_pool, tcb->kernel_stack_start, tcb->kernel_stack_end);
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief EDF only. Sets the absolute deadline of a thread, a ready thread is moved to its new
+ * place in the deadline ordered ready list.
+ * 
+ * @param[in] pointer to the tcb of the thread
+ * @param[in] new absolute deadline
+ * 
+ * @return none
+ * 
+ **/
+
+static void thread_set_deadline(tcb_t* tcb, uint32_t deadline) {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    if (tcb->in_ready) {
+        ready_remove(tcb);
+        tcb->deadline = deadline;
+        ready_insert(tcb, 0);
+    }
+    else {
+        tcb->deadline = deadline;
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+void wait_queue_insert(tcb_t** queue, tcb_t* tcb) {
+    tcb_t** link = queue;
+
+    while ((*link != NULL) && ((*link)->dynamic_priority <= tcb->dynamic_priority)) {
+        link = &(*link)->wait_next;
+    }
+    tcb->wait_next = *link;
+    *link = tcb;
+}
+
+uint32_t thread_wait(tcb_t** queue, uint32_t timeout, int interrupt_status) {
+    tcb_t* self = &TCB[currentRunningThreadID];
+
+    wait_queue_insert(queue, self);
+    self->wait_queue = queue;
+    self->wait_result = 0;
+    if (timeout != WAIT_FOREVER) {
+        self->wait_timer.tcb = self;
+        self->wait_timer.expires = global_system_time + timeout;
+        timer_queue_insert(&timeout_queue, &self->wait_timer);
+    }
+    thread_set_state(self, BLOCKED);
+    restore_interrupt_state(interrupt_status);
+
+    // PendSV preempts the SVC here and only comes back once the wait is over
+    pend_pendsv();
+
+    return self->wait_result;
+}
+
+/** @brief unlinks a thread from the wait queue it is blocked in, if any, interrupts disabled */
+static void wait_queue_remove(tcb_t* tcb) {
+    tcb_t** link = tcb->wait_queue;
+
+    while ((link != NULL) && (*link != NULL) && (*link != tcb)) {
+        link = &(*link)->wait_next;
+    }
+    if ((link != NULL) && (*link == tcb)) {
+        *link = tcb->wait_next;
+    }
+    tcb->wait_next = NULL;
+    tcb->wait_queue = NULL;
+}
+
+void thread_wake(tcb_t* tcb, uint32_t result) {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    timer_queue_remove(&timeout_queue, &tcb->wait_timer);
+
+    if ((tcb->wait_queue != NULL) || (tcb->state == SLEEPING)) {
+        wait_queue_remove(tcb);
+
+        tcb->wait_result = result;
+        thread_set_state(tcb, RUNNABLE);
+
+        if ((sched_policy == SCHED_POLICY_EDF) || (tcb->dynamic_priority < TCB[currentRunningThreadID].dynamic_priority)) {
+            pend_pendsv();
+        }
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+void timer_queue_insert(ktimer_t** queue, ktimer_t* timer) {
+    ktimer_t** link = queue;
+
+    // wrap safe comparison, timers with the same expiry stay in insertion order
+    while((*link != NULL) && ((int32_t)((*link)->expires - timer->expires) <= 0)) {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    *link = timer;
+    timer->queued = 1;
+}
+
+void timer_queue_remove(ktimer_t** queue, ktimer_t* timer) {
+    ktimer_t** link = queue;
+
+    if(!timer->queued) {
+        return;
+    }
+
+    while((*link != NULL) && (*link != timer)) {
+        link = &(*link)->next;
+    }
+
+    if(*link == timer) {
+        *link = timer->next;
+    }
+
+    timer->next = NULL;
+    timer->queued = 0;
+}
+
+/** @brief the priority of a thread which holds no mutex, lowered for a job running on after an overrun */
+static uint8_t thread_base_priority(tcb_t* tcb) {
+    return tcb->overrun_background ? BACKGROUND_PRIORITY : tcb->static_priority;
+}
+
+void thread_set_dynamic_priority(tcb_t* tcb, uint8_t prio) {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    if (tcb->in_ready) {
+        ready_remove(tcb);
+        tcb->dynamic_priority = prio;
+        // a boosted thread runs before threads whose static priority is the same level
+        ready_insert(tcb, prio < tcb->static_priority);
+    }
+    else {
+        tcb->dynamic_priority = prio;
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief Divides in Q32 without the FPU or a 64 bit division, one bit of the quotient per step.
+ * 
+ * @param[in] numerator, at most the denominator
+ * @param[in] denominator, non zero
+ * 
+ * @return num / den in Q32 rounded up
+ * 
+ **/
+
+static uint64_t q32_div(uint32_t num, uint32_t den) {
+    if (num >= den) {
+        return Q32_ONE;
+    }
+
+    uint32_t quotient = 0;
+    uint32_t remainder = num;
+
+    for (uint32_t i = 0; i < 32; i++) {
+        quotient <<= 1;
+        // remainder * 2 >= den without overflowing
+        if (remainder >= den - remainder) {
+            remainder -= den - remainder;
+            quotient |= 1;
+        }
+        else {
+            remainder <<= 1;
+        }
+    }
+
+    return (uint64_t)quotient + (remainder != 0);
+}
+
+/**
+ * 
+ * @brief Counts the live threads whose priority is equal to a task's or not in rate monotonic
+ * order with it.
+ * 
+ * @param[in] priority of the task
+ * @param[in] period of the task
+ * 
+ * @return number of such threads
+ * 
+ **/
+
+static uint32_t rm_inversions_with(uint32_t prio, uint32_t T) {
+    uint32_t inversions = 0;
+
+    for (uint32_t i = 1; i < IDLE_THREAD_ID; i++) {
+        if (TCB[i].state == STOPPED) {
+            continue;
+        }
+        if ((TCB[i].static_priority == prio) ||
+            ((TCB[i].static_priority < prio) && (TCB[i].T > T)) ||
+            ((TCB[i].static_priority > prio) && (TCB[i].T < T))) {
+            inversions++;
+        }
+    }
+
+    return inversions;
+}
+
+/** @brief adds a new live thread, not yet runnable, to the admission sums, interrupts disabled */
+static void admission_add(tcb_t* tcb) {
+    admission_epoch++;
+    rm_inversions += rm_inversions_with(tcb->static_priority, tcb->T);
+    util_sum += q32_div(tcb->C, tcb->T);
+    density_sum += q32_div(tcb->C, tcb->D);
+    if (tcb->D < tcb->T) {
+        constrained_threads++;
+    }
+}
+
+/** @brief removes a thread which is being killed, already STOPPED, from the admission sums,
+ *  interrupts disabled. The epoch moves on as well, a test which read a sum halfway through the
+ *  update cannot be trusted even though the task set only got smaller */
+static void admission_remove(tcb_t* tcb) {
+    admission_epoch++;
+    rm_inversions -= rm_inversions_with(tcb->static_priority, tcb->T);
+    util_sum -= q32_div(tcb->C, tcb->T);
+    density_sum -= q32_div(tcb->C, tcb->D);
+    if (tcb->D < tcb->T) {
+        constrained_threads--;
+    }
+}
+
+/**
+ * 
+ * @brief Table mode only. Starts a minor frame, a new job of every live thread in its slots is
+ * released.
+ * 
+ * @param[in] index of the minor frame
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+static void table_frame_start(uint32_t frame) {
+    uint8_t* slots = sched_table.slots[frame];
+
+    table_frame = frame;
+    table_frame_left = sched_table.minor_ticks;
+    table_slot = 0;
+
+    for (uint32_t i = 0; (i < SCHED_TABLE_FRAME_SLOTS) && (slots[i] != 0); i++) {
+        tcb_t* tcb = &TCB[slots[i]];
+
+        if (tcb->state == STOPPED) {
+            continue;
+        }
+
+        stats_job_release(tcb, global_system_time);
+        trace_thread_event(TRACE_RELEASE, slots[i], 0);
+        tcb->execution_time = 0;
+        tcb->job_cycles = 0;
+        if ((tcb->state != BLOCKED) && (tcb->state != SLEEPING)) {
+            thread_set_state(tcb, RUNNABLE);
+        }
+    }
+}
+
+/**
+ * 
+ * @brief Table mode only. Ends the current minor frame, the jobs of its slots which are still
+ * ready have overrun the frame and wait for their next slot.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+static void table_frame_end() {
+    uint8_t* slots = sched_table.slots[table_frame];
+
+    for (uint32_t i = 0; (i < SCHED_TABLE_FRAME_SLOTS) && (slots[i] != 0); i++) {
+        tcb_t* tcb = &TCB[slots[i]];
+
+        if ((tcb->state == RUNNABLE) || (tcb->state == RUNNING)) {
+            stats_job_end(tcb, 1);
+            thread_set_dynamic_priority(tcb, tcb->static_priority);
+            thread_set_state(tcb, WAITING);
+        }
+    }
+}
+
+/**
+ * 
+ * @brief Table mode only. Picks the first ready thread among the slots of the current minor
+ * frame. Slots whose job is done are passed for good, a blocked thread keeps its place and runs
+ * again once it is woken.
+ * 
+ * @param[in] none
+ * 
+ * @return returns the ID of the thread 
+ * 
+ **/
+
+static uint32_t table_next() {
+    uint8_t* slots = sched_table.slots[table_frame];
+
+    while ((table_slot < SCHED_TABLE_FRAME_SLOTS) && (slots[table_slot] != 0) &&
+        ((TCB[slots[table_slot]].state == WAITING) || (TCB[slots[table_slot]].state == STOPPED))) {
+        table_slot++;
+    }
+
+    for (uint32_t i = table_slot; (i < SCHED_TABLE_FRAME_SLOTS) && (slots[i] != 0); i++) {
+        state_t state = TCB[slots[i]].state;
+
+        if ((state == RUNNABLE) || (state == RUNNING)) {
+            return slots[i];
+        }
+    }
+
+    return IDLE_THREAD_ID;
+}
+
+/**
+ * 
+ * @brief Advances the scheduler by a number of ticks. The running thread is charged for all of
+ * them, the threads whose release time has been reached are made RUNNABLE and a PendSV is pended
+ * to pick the next thread.
+ * 
+ * @param[in] number of ticks which elapsed, always 1 unless in tickless mode
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+static void scheduler_tick(uint32_t ticks) {
+    global_system_time += ticks; // increment global system time counter
+    //printk("systick is working\n"); 
+    pend_pendsv();
+
+    if(TCB[currentRunningThreadID].state == RUNNING) {
+        thread_set_state(&TCB[currentRunningThreadID], RUNNABLE);
+    }
+
+    if((console_server != NULL) && console_server->server.idle && (rtt_has_data(0) != 0)) {
+        server_signal(console_server, SERVER_EVENT_CONSOLE);
+    }
+
+    // in table mode the schedule table releases the threads, one index per minor frame
+    if(table_mode) {
+        table_frame_left -= ticks;
+        if(table_frame_left == 0) {
+            table_frame_end();
+            table_frame_start((table_frame + 1 == sched_table.num_frames) ? 0 : table_frame + 1);
+        }
+    }
+
+    // only the threads at the head of the release queue can be due on this tick
+    while(!table_mode && (release_queue != NULL) && ((int32_t)(global_system_time - release_queue->expires) >= 0)) {
+        ktimer_t* release = release_queue;
+
+        if(release->tcb->type == THREAD_TYPE_SERVER) {
+            timer_queue_remove(&release_queue, release);
+            server_replenish(release->tcb);
+            continue;
+        }
+
+        uint32_t released_at = release->expires;
+
+        timer_queue_remove(&release_queue, release);
+        release->expires += release->tcb->T;
+
+        if (sched_policy == SCHED_POLICY_EDF) {
+            thread_set_deadline(release->tcb, released_at + release->tcb->D);
+        }
+        stats_job_release(release->tcb, released_at);
+        trace_thread_event(TRACE_RELEASE, release->tcb - TCB, 0);
+        if (release->tcb->overrun_background) {
+            // a job which ran on after an overrun becomes the new job, with a fresh budget
+            release->tcb->overrun_background = 0;
+            thread_set_dynamic_priority(release->tcb, release->tcb->static_priority);
+            release->tcb->execution_time = 0;
+            release->tcb->job_cycles = 0;
+        }
+        // a thread blocked on a mutex stays in its wait queue until the mutex hands over, a
+        // sleeping thread sleeps on until its wait timer
+        if ((release->tcb->state != BLOCKED) && (release->tcb->state != SLEEPING)) {
+            thread_set_state(release->tcb, RUNNABLE);
+        }
+
+        timer_queue_insert(&release_queue, release);
+    }
+
+    // expired semaphore and event waits return 0, sleeps end
+    while((timeout_queue != NULL) && ((int32_t)(global_system_time - timeout_queue->expires) >= 0)) {
+        thread_wake(timeout_queue->tcb, 0);
+    }
+
+        if(TCB[currentRunningThreadID].type == THREAD_TYPE_SERVER) {
+            server_t* server = &TCB[currentRunningThreadID].server;
+            uint32_t used = (ticks < server->budget) ? ticks : server->budget;
+
+            server->budget -= used;
+            server->consumed += used;
+        }
+
+        TCB[currentRunningThreadID].execution_time += ticks;
+        // TCB[currentRunningThreadID].time_since_scheduler_start += TCB[currentRunningThreadID].execution_time;
+        TCB[currentRunningThreadID].time_since_scheduler_start += ticks;
+
+
+    // update the status of the other tasks in the system
+    return;
+}
+
+/**
+ * 
+ * @brief This function is used to handle the interrupts which are generated by the systick timer
+ * We perform the necessary state changes and then pend the pend SV which will take care of the
+ * scheduling of the threads.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+
+void systick_c_handler() {
+    uint32_t start = probe_enter();
+    trace_isr_enter();
+    scheduler_tick(1);
+    trace_isr_exit();
+    probe_exit(PROBE_SYSTICK, start);
+}
+
+/**
+ * 
+ * @brief Tickless mode only. Accounts every tick boundary which the one shot timer counter has
+ * crossed since the last call, the partial tick carries over to the next call. All of the
+ * elapsed ticks are charged to the running thread, which ran for the whole interval because
+ * this is called before every context switch.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+static void tickless_catch_up() {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    uint32_t ticks = (oneshot_timer_now() - tick_start_count) / counts_per_tick;
+
+    if (ticks != 0) {
+        tick_start_count += ticks * counts_per_tick;
+        scheduler_tick(ticks);
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+void tickless_c_handler() {
+    tickless_catch_up();
+    // the PendSV arms the next one shot interrupt even if no tick boundary was crossed
+    pend_pendsv();
+}
+
+/**
+ * 
+ * @brief Tickless mode only. Arms the one shot timer for the earliest of the next release and
+ * the budget expiry of the thread which is about to run.
+ * 
+ * @param[in] ID of the thread which is about to run
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+static void tickless_arm(uint32_t thread_id) {
+    uint32_t ticks = tickless_max_ticks;
+    tcb_t* next = &TCB[thread_id];
+
+    if (release_queue != NULL) {
+        int32_t until_release = (int32_t)(release_queue->expires - global_system_time);
+        if (until_release < (int32_t)ticks) {
+            ticks = (until_release > 0) ? (uint32_t)until_release : 1;
+        }
+    }
+
+    if (timeout_queue != NULL) {
+        int32_t until_timeout = (int32_t)(timeout_queue->expires - global_system_time);
+        if (until_timeout < (int32_t)ticks) {
+            ticks = (until_timeout > 0) ? (uint32_t)until_timeout : 1;
+        }
+    }
+
+    if ((thread_id != MAIN_THREAD_ID) && (thread_id != IDLE_THREAD_ID)) {
+        uint32_t budget;
+
+        if (next->type == THREAD_TYPE_SERVER) {
+            budget = (next->server.budget != 0) ? next->server.budget : 1;
+        }
+        else {
+            // overruns are decided on the cycles the job ran, wake at the first tick by which
+            // they can have used up the budget
+            uint64_t budget_cycles = (uint64_t)next->C * cycles_per_tick;
+            uint64_t left = (next->job_cycles < budget_cycles) ? (budget_cycles - next->job_cycles) : 1;
+            budget = (left > __UINT32_MAX__ - cycles_per_tick) ? ticks : (((uint32_t)left + cycles_per_tick - 1) / cycles_per_tick);
+        }
+
+        if (budget < ticks) {
+            ticks = budget;
+        }
+    }
+
+    // console input is only noticed when the scheduler runs
+    if ((console_server != NULL) && console_server->server.idle && (console_server->T < ticks)) {
+        ticks = console_server->T;
+    }
+
+    oneshot_timer_set(tick_start_count + (ticks * counts_per_tick));
+}
+
+/**
+ * 
+ * @brief Charges the running thread for the cycles since it was last charged. Runs before every
+ * scheduling decision, so a job's budget counts the cycles it actually ran rather than the ticks
+ * which happened to land while it ran.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return any value 
+ * 
+ **/
+
+static void thread_charge() {
+    uint32_t now = get_cycle_count();
+
+    TCB[currentRunningThreadID].job_cycles += now - charged_at;
+    charged_at = now;
+}
+
+/**
+ * 
+ * This is the pendsv C handler which is going to take care of scheduling the next highest prio 
+ * thread ID in the system. This accepts a pointer to the msp of the task which is stored in the 
+ * stack and it will be transferred into r0 in the asm handler before the control being passed
+ * into this very c handler. This does the necessary scheduling and then passes control back into the 
+ * pend the pendsv asm handler.
+ * 
+ * @param[in] pointer to the msp
+ * 
+ * @return does not return 
+ * 
+ **/
+
+static void *pendsv_schedule(void *msp){
+    // in Systick handler, the next thread to be scheduled will be updated
+    // check for that thread and schedule it here 
+
+    // breakpoint();
+    if (tickless) {
+        // the running thread is charged up to now before it is switched out
+        tickless_catch_up();
+    }
+
+    thread_charge();
+    clear_pendsv();
+
+    msp_stack_frame_t* ptr = (msp_stack_frame_t*)msp;
+
+    // we are going to run the RMS scheduler 
+    nextThreadID = RMS(); // RMS choice - returns with min period
+
+    if (nextThreadID == IDLE_THREAD_ID) {
+        stack_scan_step();
+    }
+    
+    if (nextThreadID == 0) {
+      // stop systick timer here
+	systick_stop();
+        if (tickless) {
+            oneshot_timer_stop();
+        }
+        // the probes of a PROFILE build, once all the threads are done
+        probe_print();
+    }
+
+
+    if((nextThreadID == currentRunningThreadID) && (TCB[currentRunningThreadID].state != BLOCKED) &&
+        (TCB[currentRunningThreadID].state != SLEEPING) && (TCB[currentRunningThreadID].state != STOPPED)){
+        // return the same msp
+        thread_set_state(&TCB[currentRunningThreadID], RUNNING);
+        stats_job_start(&TCB[currentRunningThreadID]);
+        if (tickless) {
+            tickless_arm(currentRunningThreadID);
+        }
+        // printk("Scheduling thread %lu\n", currentRunningThreadID);
+        return msp;
+    }
+
+    // if there are no threads left to run in the pool
+    if(currentRunningThreadID != nextThreadID) {
+
+        
+        // breakpoint();
+        // means a different thread needs to be scheduled, save the context
+
+        TCB[currentRunningThreadID].msp = ptr; // save the ptr
+            
+        TCB[currentRunningThreadID].svc_status = get_svc_status();
+
+        // a stack sits at the top of its region, below it are the disabled sub-regions
+        uint8_t size = TCB[nextThreadID].stack_log2;
+        uint8_t srd = TCB[nextThreadID].stack_srd;
+        uint32_t region_mask = ~((1U << size) - 1);
+
+        if(!kernel_mode_set) {
+            if (currentRunningThreadID != 0) {
+                mm_region_disable(USER_REGION);
+            }
+            if (mm_region_enable_srd(USER_REGION, (void*)((uint32_t)TCB[nextThreadID].user_stack_start & region_mask), size, srd, 0, 1) != 0) {
+                 printk("Enable USER_REGION mem protection failed for thread id = %d\n", nextThreadID);
+            }
+        }
+        if (currentRunningThreadID != 0) mm_region_disable(KERNEL_REGION);
+        if (mm_region_enable_srd(KERNEL_REGION, (void*)((uint32_t)TCB[nextThreadID].kernel_stack_start & region_mask), size, srd, 0, 1) != 0) {
+            printk("Enable KERNEL_REGION mem protection failed for thread id = %d\n", nextThreadID);
+        }
+            
+    }
+    
+        // schedule the next thread
+        thread_set_state(&TCB[nextThreadID], RUNNING);
+        stats_job_start(&TCB[nextThreadID]);
+
+        currentRunningThreadID = nextThreadID;
+
+        set_svc_status(TCB[currentRunningThreadID].svc_status);
+
+        if (tickless && (nextThreadID != MAIN_THREAD_ID)) {
+            tickless_arm(nextThreadID);
+        }
+
+        //printk("Scheduling thread %lu\n", currentRunningThreadID);
+
+        return (void*)TCB[nextThreadID].msp;
+}
+
+/**
+ * 
+ * @brief Entry point from pendsv_asm_handler, see pendsv_schedule(). With PROFILE defined the
+ * cycles spent scheduling are measured by PROBE_PENDSV.
+ * 
+ * @param[in] pointer to the msp
+ * 
+ * @return msp of the thread to run next
+ * 
+ **/
+
+void *pendsv_c_handler(void *msp){
+    uint32_t start = probe_enter();
+    uint32_t prev_thread = currentRunningThreadID;
+    trace_isr_enter();
+    void* next_msp = pendsv_schedule(msp);
+
+    // every thread has its own kernel stack
+    if (next_msp != msp) {
+        probe_switched();
+        trace_event(TRACE_SWITCH, prev_thread);
+    }
+
+    trace_isr_exit();
+    probe_exit(PROBE_PENDSV, start);
+
+    return next_msp;
+}
+
+/**
+ * 
+ * 
+ * @brief This is the default idle thread function which acts as a helper to call the wait_for_interrupt
+ * function. When no threads remain in the system, then this idle thread is scheduled to run.
+ * 
+ * @params[in] none
+ * 
+ * @return does not return 
+ * 
+ **/
+
+void default_idle_helper()
+{
+	//default_idle();
+        while (1) {
+ 		wait_for_interrupt();
+	}
+}
+
+/**
+ * 
+ * @brief This function is used to append an new mutex into the linked list of mutexes. It takes in
+ * a pointer to the start of the list and also a pointer to the new mutex which must be added into
+ * the linked list.
+ * 
+ * @param[in] pointer to the start of the linked list
+ * @param[in] pointer to the mutex which needs to be added into the list
+ * 
+ * @return does not return 
+ * 
+ */
+
+void append_mutex_list(kmutex_t** start, kmutex_t* new_mutex) {
+    return;
+        if (*start == NULL) {
+                new_mutex->next = NULL;
+                *start = new_mutex;
+                return;
+        }
+        kmutex_t* node = *start;
+        while (node->next != NULL) {
+                node = node->next;
+        }
+        new_mutex->next = NULL;
+        node->next = new_mutex;
+}
+
+/**
+ * 
+ * This function is used to append a new tcb into the linked list of TCBs that we maintain
+ * in our kernel. This takes in a pointer to the start of the linked list and a pointer to the
+ * new tcb which needs to be added.
+ * 
+ * @param[in] start of the tcb linked list
+ * @param[in] pointer to the new tcb
+ * 
+ * @return does not return 
+ * 
+ **/
+
+
+void append_tcb_list(tcb_t** start, tcb_t* new_tcb) {
+	if (*start == NULL) {
+        new_tcb->next = NULL;
+		*start = new_tcb;
+		return;
+	}
+    tcb_t* node = *start;
+	while (node->next != NULL) {
+        // printk("Node is %p\n", node);
+		node = node->next;
+	}
+
+    if(new_tcb != node) {
+    new_tcb->next = NULL;
+    node->next = new_tcb;       
+    }
+
+}
+
+/**
+ * 
+ * @brief This function is used to delete a tcb from the linked list of the TCBs. It also takes a pointer 
+ * to the tcb which has to be deleted from the linked list. 
+ * 
+ * @params[in] pointer to the linked list from which the tcb has to be deleted
+ * @params[in] pointer to the tcb which has to be deleted from the linked list
+ * 
+ * @return does not return 
+ * 
+ **/
+
+
+void delete_tcb(tcb_t** start, tcb_t* del_tcb) {
+	if (*start == NULL) {
+		return;
+	}
+	// if del_tcb is first node in list
+	if (*start == del_tcb) {
+		*start = del_tcb->next;
+        del_tcb->next = NULL;
+		return;
+	}
+	tcb_t* node = *start;
+        while (node->next != del_tcb) {
+                node = node->next;
+        }
+        if (node != *start) {
+        	node->next = del_tcb->next;
+            del_tcb->next = NULL;
+	}
+}
+
+/**
+ * 
+ * @brief This function is used to delete a mutex from the linked list of the mutexes. It also takes a pointer 
+ * to the mutex which has to be deleted from the linked list. 
+ * 
+ * @params[in] pointer to the linked list from which the mutex has to be deleted
+ * @params[in] pointer to the mutex which has to be deleted from the linked list
+ * 
+ * @return does not return 
+ * 
+ **/
+
+void delete_mutex(kmutex_t** start, kmutex_t* del_mutex) {
+    return;
+	if (*start == NULL) {
+		return;
+	}
+	// if del_tcb is first node in list
+	if (*start == del_mutex) {
+		*start = del_mutex->next;
+        del_mutex->next = NULL;
+		return;
+	}
+	kmutex_t* node = *start;
+        while (node->next != del_mutex) {
+                node = node->next;
+        }
+        if (node != *start) {
+        	node->next = del_mutex->next;
+            del_mutex->next = NULL;
+	}
+}
+
+/**
+ * 
+ * @brief This is the function that is used to get the first free tcb from the linked list of TCBs.
+ * It takes in a pointer to the tcb which needs to be deleted.
+ * 
+ * @params[in] pointer to tcb which has to be deleted from the list
+ * 
+ * @return returns a pointer to the tcb which has been fetched from the linked list
+ * 
+ **/
+
+tcb_t* get_first_tcb(tcb_t** start) {
+        tcb_t* first = *start;
+	if (first == NULL) {
+		printk("freelist is empty\n");
+                return NULL;
+        }
+	if (first->next == NULL) {
+                //printk("failed to make second tcb\n");
+		*start = NULL;
+        first->next = NULL;
+        return first;
+	}
+	else {
+		tcb_t* result = first;
+		*start = first->next;
+		result->next = NULL;
+		return result;
+	}
+}
+
+/**
+ * 
+ * @brief Gives a stopped tcb back to the free list, at its tail so that the statistics and exit
+ * code of a killed thread are kept as long as possible. O(1), safe against a create or kill
+ * preempting the caller.
+ * 
+ * @param[in] pointer to the tcb
+ * 
+ * @return none
+ * 
+ **/
+
+static void free_tcb_put(tcb_t* tcb) {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    tcb->next = NULL;
+    if (free_tcb_list == NULL) {
+        free_tcb_list = tcb;
+    }
+    else {
+        free_tcb_tail->next = tcb;
+    }
+    free_tcb_tail = tcb;
+
+    restore_interrupt_state(interrupt_status);
+}
+
+/**
+ * 
+ * @brief Takes the oldest tcb off the free list. O(1), safe against a create or kill preempting
+ * the caller.
+ * 
+ * @return pointer to the tcb, NULL if every tcb is in use
+ * 
+ **/
+
+static tcb_t* free_tcb_take() {
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    tcb_t* tcb = get_first_tcb(&free_tcb_list);
+    if (free_tcb_list == NULL) {
+        free_tcb_tail = NULL;
+    }
+
+    restore_interrupt_state(interrupt_status);
+    return tcb;
+}
+
+/**
+ * 
+ * @brief We maintain a free list of mutexes. This function loops through the free list
+ * and returns the next free mutex.
+ * 
+ * @param[in] Pointer to the start of the linked list of mutexes from where we need to fetch the mutex
+ * from 
+ * .
+ * 
+ * @return Returns a pointer to the mutex which has been fetched from the linked list of the mutexes.
+ * 
+ */
+
+
+kmutex_t* get_first_mutex(kmutex_t** start) {
+        kmutex_t* first = *start;
+        if (first == NULL) {
+                printk("freelist of kmutex_t is empty\n");
+                return NULL;
+        }
+        if (first->next == NULL) {
+                //printk("failed to make second kmutex_t\n");
+                *start = NULL;
+                first->next = NULL;
+                return first;
+        }
+        else {
+                kmutex_t* result = first;
+                *start = first->next;
+                result->next = NULL;
+                return result;
+        }
+}
+
+/**
+ * 
+ * @brief This is the system call that is used to initialise the threads of the system. This takes
+ * in all the details from the user like maximum threads to be created, size of the stack for each
+ * thread, pointer to the idle function, mode of memory protection and the maximum mutexes needed.
+ * 
+ * @param[in] maximum number of threads of the system
+ * @param[in] stack size for each thread
+ * @param[in] pointer to the idle function
+ * @param[in] memory protection - kernel only or per thread protection
+ * @param[in] maximum number of mutexes in the system
+ * @param[in] scheduling policy, SCHED_POLICY_RMS or SCHED_POLICY_EDF
+ * 
+ * @return -1 on failure and 0 on success
+ * 
+ **/
+
+
+int sys_thread_init(uint32_t max_threads, uint32_t stack_size, void* idle_fn, mpu_mode memory_protection, uint32_t user_max_mutexes, uint32_t policy) {
+
+   if ((policy != SCHED_POLICY_RMS) && (policy != SCHED_POLICY_EDF)) {
+       printk("Unknown scheduling policy %lu\n", policy);
+       return -1;
+   }
+
+   if ((max_threads > MAX_THREADS) || (user_max_mutexes > MAX_MUTEXES)) {
+       printk("At most %d threads and %d mutexes, see kernel_config.h\n", MAX_THREADS, MAX_MUTEXES);
+       return -1;
+   }
+
+   int interrupt_status = save_interrupt_state_and_disable();
+
+   sched_policy = policy;
+
+   if (idle_fn == NULL) {
+       idle_fn = &default_idle;
+    }
+    max_mutexes = user_max_mutexes;
+
+    max_threads_from_user = max_threads;
+
+    default_stack_size = stack_size * 4;
+
+    if((stack_pool_init(&kernel_stack_pool, (void*)&__thread_k_stacks_limit, (uint32_t)(&__thread_k_stacks_base) - (uint32_t)(&__thread_k_stacks_limit)) != 0) ||
+        (stack_pool_init(&user_stack_pool, (void*)&__thread_u_stacks_limit, (uint32_t)(&__thread_u_stacks_base) - (uint32_t)(&__thread_u_stacks_limit)) != 0)) {
+            printk("Thread stack regions must be aligned powers of two\n");
+            restore_interrupt_state(interrupt_status);
+            return -1;
+        }
+
+    // initialise idle thread TCB, its stacks are the first ones out of the pools
+    tcb_t* idle = &TCB[IDLE_THREAD_ID];
+
+    if(thread_stacks_alloc(idle, default_stack_size) != 0) {
+            printk("Stack is oversized bro, reduce it\n");
+            restore_interrupt_state(interrupt_status);
+            return -1;
+        }
+    // initialise the stack data structures
+    
+    if(!memory_protection) {
+        kernel_mode_set = 1;
+        mm_region_enable(USER_REGION, (void*)&__thread_u_stacks_limit, mm_log2ceil_size(32768), 0, 1);
+    }
+
+    // user thread stacks are allocated by thread create, freed by thread kill
+    for(uint32_t i = 0; i < max_threads; i++) {
+        // breakpoint();
+        TCB[i+1].fn = idle_fn;
+        TCB[i+1].joiners = NULL;
+        free_tcb_put(&TCB[i+1]);
+        TCB[i+1].state = STOPPED;
+   } 
+    // initialized free mutex list
+    for (uint32_t i = 0; i < max_mutexes; i++) {
+        MU[i].owner = NULL;
+        MU[i].locked_by = __UINT32_MAX__;
+        MU[i].next = NULL;
+        MU[i].prev = NULL;
+        MU[i].waiting_threads = NULL;
+        //append_mutex_list(&free_mutex_list, &MU[i]);
+    }
+    available_mutexes = max_mutexes;
+    ceiling_group = 0;
+    for (uint32_t i = 0; i < NUM_PRIO_WORDS; i++) {
+        ceiling_bitmap[i] = 0;
+    }
+    for (uint32_t i = 0; i < NUM_PRIO_LEVELS; i++) {
+        ceiling_head[i] = NULL;
+    }
+    // main already has msp and psp initialized do not waste stack region for this
+    TCB[0].msp->lr = (void*)LR_RETURN_TO_USER_PSP;
+    TCB[0].prio = max_threads;
+    TCB[0].msp->psp->xPSR = XPSR_INIT;
+    TCB[0].svc_status = 0;
+    TCB[0].kernel_stack_start = (void*)& __msp_stack_limit;
+    TCB[0].user_stack_start = (void*)& __psp_stack_limit;
+    TCB[0].stack_log2 = mm_log2ceil_size(2048);
+    TCB[0].stack_srd = 0;
+
+
+    idle->msp = (msp_stack_frame_t*)((char*)idle->kernel_stack_end - sizeof(msp_stack_frame_t));
+    idle->msp->psp = (interrupt_stack_frame*)((char*)idle->user_stack_end - sizeof(interrupt_stack_frame));
+    // idle->msp->psp->r0 = (uint32_t)vargp;
+
+    idle->msp->lr = (void*)LR_RETURN_TO_USER_PSP;
+    idle->prio = __UINT32_MAX__;
+    idle->msp->psp->xPSR = XPSR_INIT;
+    idle->svc_status = 0;
+    idle->C = __UINT32_MAX__;
+    idle->T = __UINT32_MAX__;
+    idle->state = RUNNABLE;
+    idle->running_time = 0;
+    idle->execution_time = 0;
+
+    idle->msp->psp->pc = idle_fn;
+    idle->msp->psp->lr = &default_idle;
+    idle->msp->psp->xPSR = XPSR_INIT;
+    // setting everything to 0 so that all registers are clear when first init happens
+    idle->msp->psp->r1 = 0;
+    idle->msp->psp->r2 = 0;
+    idle->msp->psp->r3 = 0;
+    idle->msp->psp->r12 = 0;
+    idle->msp->r4 = 0;
+    idle->msp->r5 = 0;
+    idle->msp->r6 = 0;
+    idle->msp->r7 = 0;
+    idle->msp->r8 = 0;
+    idle->msp->r9 = 0;
+    idle->msp->r10 = 0;
+    idle->msp->r11 = 0;
+    idle->running_time = 0;
+    idle->svc_status = 0;
+    idle->execution_time = 0;
+    idle->static_priority = __UINT8_MAX__;
+    idle->time_since_scheduler_start = 0;
+    
+    restore_interrupt_state(interrupt_status);
+    return 0;
+}
+
+/**
+ * 
+ * @brief Runs the admission test of the scheduling policy for a new task against the live
+ * threads. Nothing is written, so it may run with interrupts enabled.
+ * 
+ * @param[in] priority of the task
+ * @param[in] WCET of the task
+ * @param[in] period of the task
+ * @param[in] relative deadline of the task
+ * 
+ * @return 0 if the task can be admitted, -1 otherwise
+ * 
+ **/
+
+static int admission_test(uint32_t priority, uint32_t C, uint32_t T, uint32_t D) {
+    if(table_loaded) {
+        // the schedule table was checked when it was built
+        return 0;
+    }
+
+    if(sched_policy == SCHED_POLICY_EDF) {
+        if(UB_test_EDF(C, D) == -1) {
+            printk("EDF utilization test failed\n");
+            return -1;
+        }
+        return 0;
+    }
+
+    // the utilization bound settles most task sets, the exact analysis the rest
+    int bound = UB_test_RMS(priority, C, T, D);
+
+    if((bound == -1) || ((bound == 0) && (RTA_test_RMS(priority, C, T, D) == -1))) {
+        printk("Response time test failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+/** @brief create a new thread as specified, if UB allows
+ *
+ *  @param fn       thread function pointer
+ *  @param prio     thread priority, with 0 being highest
+ *  @param C        execution time (scheduler ticks)
+ *  @param T        task period (scheduler ticks)
+ *  @param vargp    thread function argument
+ *
+ *  @return     0 for success, -1 for failure
+ */
+
+int sys_thread_create(void* fn, uint32_t priority, uint32_t C, uint32_t T, void* vargp) {
+    thread_attr_t attr = { .C = C, .T = T, .D = T, .type = THREAD_TYPE_PERIODIC };
+
+    return sys_thread_create_attr(fn, priority, &attr, vargp);
+}
+
+/** @brief create a new thread with the timing attributes in attr, if the
+ *  admission test allows
+ *
+ *  @param fn       thread function pointer
+ *  @param prio     thread priority, with 0 being highest
+ *  @param attr     timing attributes of the thread, deadline may be shorter than the period
+ *  @param vargp    thread function argument
+ *
+ *  @return     0 for success, -1 for failure
+ */
+
+int sys_thread_create_attr(void* fn, uint32_t priority, thread_attr_t* attr, void* vargp) {
+
+    // printk("Thread has priority %lu and Period %lu\n", priority, T);
+
+    if(attr == NULL) {
+        return -1;
+    }
+
+    uint32_t C = attr->C;
+    uint32_t T = attr->T;
+    uint32_t D = (attr->D == 0) ? T : attr->D;
+
+    if((T == 0) || (C > D) || (D > T)) {
+        printk("Invalid timing, need C <= D <= T and T > 0\n");
+        return -1;
+    }
+    
+    if(priority >= BACKGROUND_PRIORITY) {
+        printk("Prio must be less than %d, the lowest level is kept for overrunning jobs\n", BACKGROUND_PRIORITY);
+        return -1;
+    }
+
+    if((attr->type != THREAD_TYPE_PERIODIC) && (attr->type != THREAD_TYPE_SERVER)) {
+        printk("Unknown thread type %lu\n", attr->type);
+        return -1;
+    }
+
+    if((attr->type == THREAD_TYPE_SERVER) && (sched_policy == SCHED_POLICY_EDF)) {
+        printk("Sporadic servers need fixed priorities\n");
+        return -1;
+    }
+
+    // a sporadic server is always held to its replenished budget
+    if((attr->overrun > OVERRUN_KILL) || ((attr->type == THREAD_TYPE_SERVER) && (attr->overrun != OVERRUN_SUSPEND))) {
+        printk("Unknown overrun policy %lu for this thread type\n", attr->overrun);
+        return -1;
+    }
+
+    if((attr->phase >= T) || ((attr->type == THREAD_TYPE_SERVER) && (attr->phase != 0))) {
+        printk("Release phase %lu must be below T, and 0 for a server\n", attr->phase);
+        return -1;
+    }
+
+    if(totalThreads > max_threads_from_user) {
+        printk("Exceeded thread limit, %u, max threads is %u\n", totalThreads, max_threads_from_user);
+        return -1;
+    }
+
+    uint32_t stack_size = (attr->stack_size == 0) ? default_stack_size : attr->stack_size * 4;
+
+    if(table_mode) {
+        printk("Threads cannot be added while the schedule table runs\n");
+        return -1;
+    }
+
+    //breakpoint();   
+    // find empty TCB, it stays STOPPED and out of the admission tests until it is admitted
+    tcb_t* tcb = free_tcb_take();
+    //printk("Got tcb %p\n", tcb);
+    if (tcb == NULL) {
+        printk("No free TCB\n");
+        return -1;
+    } 
+    if (thread_stacks_alloc(tcb, stack_size) != 0) {
+        printk("No room for a %lu byte stack\n", stack_size);
+        free_tcb_put(tcb);
+        return -1;
+    }
+    tcb_init(tcb, fn, vargp, priority, C, T);
+    tcb->D = D;
+
+    // The test runs with interrupts enabled, against the live threads as they are. A create or
+    // kill which preempts it moves the epoch on and the test runs again, so the scheduler is
+    // never held up for a whole response time analysis
+    int interrupt_status;
+
+    while(1) {
+        uint32_t epoch = admission_epoch;
+
+        if(admission_test(priority, C, T, D) != 0) {
+            thread_stacks_free(tcb);
+            free_tcb_put(tcb);
+            return -1;
+        }
+
+        interrupt_status = save_interrupt_state_and_disable();
+        if(epoch == admission_epoch) {
+            break;
+        }
+        restore_interrupt_state(interrupt_status);
+    }
+
+    // admitted, the thread joins the sums and the run queue at once so that the next test sees it
+    totalThreads++;
+    live_threads++;
+    admission_add(tcb);
+    if(table_loaded) {
+        // the thread skipped the tests, the scheduler can only start in table mode from now on
+        table_admitted = 1;
+    }
+
+    invocations++; // successfully created 
+
+    tcb->release_timer.tcb = tcb;
+    tcb->type = attr->type;
+    tcb->overrun_policy = attr->overrun;
+    tcb->deadline = global_system_time + D;
+    // releases fall phase ticks after every period boundary, as if the thread had existed
+    // since time 0. The first is the earliest of them not before the creation, the job is
+    // released on creation only when it falls there, so that no two jobs are ever released less
+    // than a period apart. A server starts at once
+    uint32_t phase = attr->phase;
+    uint32_t first_release = (global_system_time <= phase) ? phase : ((((global_system_time - phase) + T - 1) / T) * T + phase);
+    uint32_t released = (tcb->type == THREAD_TYPE_SERVER) || (first_release == global_system_time);
+    if(released) {
+        stats_job_release(tcb, global_system_time);
+    }
+
+    if(tcb->type == THREAD_TYPE_SERVER) {
+        // a server starts with a full budget and runs until its first server_wait
+        tcb->server.events = attr->events;
+        tcb->server.budget = C;
+        if(attr->events & SERVER_EVENT_CONSOLE) {
+            console_server = tcb;
+        }
+        server_activate(tcb);
+    }
+    else {
+        // staggered phases keep threads of harmonic periods from all being released on the
+        // same tick, the admission tests still assume they are
+        tcb->release_timer.expires = released ? (global_system_time + T) : first_release;
+        timer_queue_insert(&release_queue, &tcb->release_timer);
+        thread_set_state(tcb, released ? RUNNABLE : WAITING);
+    }
+    attr->tid = tcb - TCB;
+    restore_interrupt_state(interrupt_status);
+
+    // printk("Successfully created %u threads \n", invocations);
+    return 0;
+}
+
+/**
+ * 
+ * @brief We maintain a linked list of all the TCBs. This function is used to initialise the linked 
+ * list of the TCBs. It takes in the same paramters as sys_thread create and then assigns it to
+ * the individual fields in the TCB.
+ * 
+ * @param fn       thread function pointer
+ * @param prio     thread priority, with 0 being highest
+ * @param C        execution time (scheduler ticks)
+ * @param T        task period (scheduler ticks)
+ * @param vargp    thread function argument
+ * 
+ * @return     0 for success, -1 for failure
+ * 
+ **/
+
+void tcb_init(tcb_t* tcb, void* fn, void* vargp, uint32_t priority, uint32_t C, uint32_t T) {
+    //breakpoint();
+    tcb->msp = (msp_stack_frame_t*)((char*)tcb->kernel_stack_end - sizeof(msp_stack_frame_t));
+    tcb->msp->lr = (void*)LR_RETURN_TO_USER_PSP;
+    tcb->prio = priority;
+    tcb->state = STOPPED;
+    tcb->msp->psp = (interrupt_stack_frame*)((char*)tcb->user_stack_end - sizeof(interrupt_stack_frame));
+    //printk("stack is %p \n", tcb->msp->psp);
+    tcb->msp->psp->r0 = (uint32_t)(vargp);
+    //printk("Argument in sys thread create is %s\n",tcb->msp->psp->r0);
+    tcb->msp->psp->pc = fn;
+    tcb->msp->psp->lr = (void*)&thread_kill_working;
+    tcb->msp->psp->xPSR = XPSR_INIT;
+    // setting everything to 0 so that all registers are clear when first init happens
+    tcb->msp->psp->r1 = 0;
+    tcb->msp->psp->r2 = 0;
+    tcb->msp->psp->r3 = 0;
+    tcb->msp->psp->r12 = 0;
+    tcb->msp->r4 = 0;
+    tcb->msp->r5 = 0;
+    tcb->msp->r6 = 0;
+    tcb->msp->r7 = 0;
+    tcb->msp->r8 = 0;
+    tcb->msp->r9 = 0;
+    tcb->msp->r10 = 0;
+    tcb->msp->r11 = 0;
+    tcb->running_time = 0;
+    tcb->C = C; // assign C
+    tcb->T = T; // assign T
+    tcb->svc_status = 0;
+    tcb->execution_time = 0;
+    tcb->static_priority = priority;
+    tcb->dynamic_priority = priority;
+    tcb->time_since_scheduler_start = 0;
+    tcb->acquired_mutexes = NULL;
+    tcb->wait_next = NULL;
+    tcb->handoff = NULL;
+    tcb->wait_queue = NULL;
+    tcb->job_active = 0;
+    tcb->job_started = 0;
+    stats_reset(&tcb->stats);
+    tcb->job_cycles = 0;
+    tcb->overrun_policy = OVERRUN_SUSPEND;
+    tcb->overrun_background = 0;
+    tcb->overrun_pending = 0;
+    tcb->type = THREAD_TYPE_PERIODIC;
+    tcb->server.events = 0;
+    tcb->server.pending = 0;
+    tcb->server.budget = 0;
+    tcb->server.consumed = 0;
+    tcb->server.active = 0;
+    tcb->server.idle = 0;
+    tcb->server.repl_head = 0;
+    tcb->server.repl_count = 0;
+    tcb->exit_code = 0;
+    tcb->joiners = NULL;
+}
+
+/**
+ * 
+ * @brief Checks the loaded schedule table against the live threads and releases the threads of
+ * the first minor frame. Every thread waits for its first slot, the jobs released on creation are
+ * dropped.
+ * 
+ * @param[in] scheduler mode, the table runs off the periodic tick only
+ * 
+ * @return 0 on success, -1 if the table cannot run
+ * 
+ **/
+
+static int table_start(uint32_t mode) {
+    if (!table_loaded) {
+        printk("No schedule table, call sched_table_set first\n");
+        return -1;
+    }
+
+    if (mode & SCHED_MODE_TICKLESS) {
+        printk("The schedule table needs the periodic tick\n");
+        return -1;
+    }
+
+    for (uint32_t frame = 0; frame < sched_table.num_frames; frame++) {
+        for (uint32_t i = 0; (i < SCHED_TABLE_FRAME_SLOTS) && (sched_table.slots[frame][i] != 0); i++) {
+            tcb_t* tcb = &TCB[sched_table.slots[frame][i]];
+
+            if (tcb->state == STOPPED) {
+                printk("Schedule table frame %lu names thread %u which does not exist\n", frame, sched_table.slots[frame][i]);
+                return -1;
+            }
+        }
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    for (uint32_t tid = 1; tid < IDLE_THREAD_ID; tid++) {
+        if (TCB[tid].state == STOPPED) {
+            continue;
+        }
+        if (TCB[tid].type == THREAD_TYPE_SERVER) {
+            restore_interrupt_state(interrupt_status);
+            printk("Sporadic servers need the priority scheduler\n");
+            return -1;
+        }
+    }
+
+    for (uint32_t tid = 1; tid < IDLE_THREAD_ID; tid++) {
+        if (TCB[tid].state != STOPPED) {
+            TCB[tid].job_active = 0;
+            thread_set_state(&TCB[tid], WAITING);
+        }
+    }
+
+    table_mode = 1;
+    table_frame_start(0);
+    restore_interrupt_state(interrupt_status);
+    return 0;
+}
+
+int sys_sched_table_set(sched_table_t* table) {
+    if (sched_frequency != 0) {
+        printk("The schedule table must be set before the scheduler starts\n");
+        return -1;
+    }
+
+    if (table == NULL) {
+        if (table_admitted) {
+            printk("Threads were admitted against the schedule table, it cannot be unloaded\n");
+            return -1;
+        }
+        table_loaded = 0;
+        return 0;
+    }
+
+    if ((table->minor_ticks == 0) || (table->num_frames == 0) || (table->num_frames > SCHED_TABLE_MAX_FRAMES)) {
+        printk("A schedule table needs 1 to %d minor frames of at least a tick\n", SCHED_TABLE_MAX_FRAMES);
+        return -1;
+    }
+
+    for (uint32_t frame = 0; frame < table->num_frames; frame++) {
+        uint8_t* slots = table->slots[frame];
+
+        for (uint32_t i = 0; (i < SCHED_TABLE_FRAME_SLOTS) && (slots[i] != 0); i++) {
+            if (slots[i] > max_threads_from_user) {
+                printk("Schedule table frame %lu names thread %u, at most %lu threads\n", frame, slots[i], max_threads_from_user);
+                return -1;
+            }
+            // one job per thread and frame, a second release would count as a deadline miss
+            for (uint32_t j = 0; j < i; j++) {
+                if (slots[j] == slots[i]) {
+                    printk("Schedule table frame %lu names thread %u twice\n", frame, slots[i]);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    uint32_t* dst = (uint32_t*)&sched_table;
+    uint32_t* src = (uint32_t*)table;
+
+    for (uint32_t i = 0; i < (sizeof(sched_table_t) / sizeof(uint32_t)); i++) {
+        dst[i] = src[i];
+    }
+    table_loaded = 1;
+    return 0;
+}
+
+/** @brief tell the kernel to start running threads using Systick
+ *  @note  returns only after all threads complete or are killed
+ *
+ *  In tickless mode a free running counter keeps the time and a one shot compare
+ *  interrupt is armed for the next release or budget expiry only. Threads which
+ *  poll get_time()/thread_time() with wfi should use the periodic mode, they sleep
+ *  until the next armed interrupt.
+ *
+ *  In table mode the tick releases the threads of the schedule table loaded by
+ *  sys_sched_table_set and the scheduler runs them in slot order, no priorities
+ *  are compared.
+ *
+ *  @param frequency  frequncy of context switches in Hz
+ *  @param mode       SCHED_MODE_PERIODIC, SCHED_MODE_TICKLESS or SCHED_MODE_TABLE
+ *
+ *  @return     0 for success, -1 for failure
+ */
+
+int sys_scheduler_start(uint32_t frequency, uint32_t mode) {
+    if ((frequency == 0) || (frequency > PROC_FREQ)) {
+        return -1;
+    }
+
+    // a failed start leaves the kernel as it was, everything is checked before it changes
+    if ((mode & SCHED_MODE_TICKLESS) && (frequency > ONESHOT_TIMER_FREQ)) {
+        printk("Tickless mode supports at most %d Hz\n", ONESHOT_TIMER_FREQ);
+        return -1;
+    }
+
+    if (table_loaded && !(mode & SCHED_MODE_TABLE)) {
+        printk("A schedule table is loaded, the threads may only run in table mode\n");
+        return -1;
+    }
+
+    if (mode & SCHED_MODE_TABLE) {
+        if (table_start(mode) != 0) {
+            return -1;
+        }
+    }
+
+    sched_frequency = frequency;
+    cycles_per_tick = PROC_FREQ / frequency;
+    charged_at = get_cycle_count();
+
+    if (mode & SCHED_MODE_TICKLESS) {
+        counts_per_tick = ONESHOT_TIMER_FREQ / frequency;
+        tickless_max_ticks = frequency; // re-arm at least once a second
+        tick_start_count = 0;
+        tickless = 1;
+        oneshot_timer_start();
+    }
+    else {
+        systick_start(frequency);
+    }
+
+    pend_pendsv();
+    return 0;
+}
+
+int sys_sleep_until(uint32_t wake_at) {
+    tcb_t* self = &TCB[currentRunningThreadID];
+
+    if ((currentRunningThreadID == MAIN_THREAD_ID) || (currentRunningThreadID == IDLE_THREAD_ID)) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if ((int32_t)(wake_at - global_system_time) <= 0) {
+        restore_interrupt_state(interrupt_status);
+        return 0;
+    }
+
+    self->wait_queue = NULL;
+    self->wait_result = 0;
+    self->wait_timer.tcb = self;
+    self->wait_timer.expires = wake_at;
+    timer_queue_insert(&timeout_queue, &self->wait_timer);
+    thread_set_state(self, SLEEPING);
+    restore_interrupt_state(interrupt_status);
+
+    // PendSV preempts the SVC here and only comes back once the timer expired
+    pend_pendsv();
+    return 0;
+}
+
+int sys_sleep_ticks(uint32_t ticks) {
+    return sys_sleep_until(global_system_time + ticks);
+}
+
+uint32_t ticks_from_ms(uint32_t ms) {
+    // split so that ms * frequency does not overflow, the kernel has no 64 bit division
+    return (ms / 1000) * sched_frequency + ((ms % 1000) * sched_frequency + 999) / 1000;
+}
+
+/** @brief get the dynamic priority of the running thread 
+ * 
+ * @param no input paramters
+ * 
+ * @return returns the priority of the thread
+ * 
+ **/
+
+uint32_t sys_get_priority() {
+    return TCB[currentRunningThreadID].dynamic_priority;
+}
+
+/** @brief get the current time in ticks 
+ * 
+ * @param no input parameters
+ * 
+ * @return global system time which is mainted by the system
+ * 
+ **/
+
+uint32_t sys_get_time() {
+    if (tickless) {
+        tickless_catch_up();
+    }
+    return global_system_time;
+}
+
+/** @brief get the ID of the running thread, the TCB index
+ * 
+ * @param no input parameters
+ * 
+ * @return ID of the running thread
+ * 
+ **/
+
+uint32_t sys_get_pid() {
+    return currentRunningThreadID;
+}
+
+/** @brief copy the timing statistics of a thread
+ *
+ *  The statistics of a thread are kept after it is killed, until its TCB is
+ *  reused by a new thread.
+ *
+ *  @param tid      ID of the thread, as returned by getpid()
+ *  @param stats    where to copy the statistics
+ *
+ *  @return     0 for success, -1 for failure
+ */
+
+int sys_thread_stats(uint32_t tid, thread_stats_t* stats) {
+    if ((tid == MAIN_THREAD_ID) || (tid >= IDLE_THREAD_ID) || (stats == NULL)) {
+        return -1;
+    }
+
+    uint32_t* dst = (uint32_t*)stats;
+    uint32_t* src = (uint32_t*)&TCB[tid].stats;
+
+    // a consistent snapshot, the tick handler updates the statistics
+    int interrupt_status = save_interrupt_state_and_disable();
+    for (uint32_t i = 0; i < (sizeof(thread_stats_t) / sizeof(uint32_t)); i++) {
+        dst[i] = src[i];
+    }
+    restore_interrupt_state(interrupt_status);
+
+    stats->response_avg = (stats->jobs != 0) ? (stats->response_total / stats->jobs) : 0;
+    stats->jitter = (stats->latency_max >= stats->latency_min) ? (stats->latency_max - stats->latency_min) : 0;
+
+    return 0;
+}
+
+/** @brief copy the stack high water marks of a thread
+ *
+ *  The marks are kept by the stack scan, which checks a few words whenever
+ *  the CPU goes idle. They lag behind by at most one pass over the unused
+ *  parts of the stacks. A killed thread keeps the marks found before it
+ *  was killed.
+ *
+ *  @param tid      ID of the thread, as returned by getpid(), or the idle thread
+ *  @param usage    where to copy the stack use
+ *
+ *  @return     0 for success, -1 for failure
+ */
+
+int sys_thread_stack_usage(uint32_t tid, stack_usage_t* usage) {
+    if ((tid == MAIN_THREAD_ID) || (tid > IDLE_THREAD_ID) || (usage == NULL)) {
+        return -1;
+    }
+
+    tcb_t* tcb = &TCB[tid];
+
+    // a consistent snapshot, the scan moves the marks from the PendSV
+    int interrupt_status = save_interrupt_state_and_disable();
+    usage->user_size = (uint32_t)tcb->user_stack_end - (uint32_t)tcb->user_stack_start;
+    usage->user_used = (uint32_t)tcb->user_stack_end - (uint32_t)tcb->user_stack_mark;
+    usage->kernel_size = (uint32_t)tcb->kernel_stack_end - (uint32_t)tcb->kernel_stack_start;
+    usage->kernel_used = (uint32_t)tcb->kernel_stack_end - (uint32_t)tcb->kernel_stack_mark;
+    restore_interrupt_state(interrupt_status);
+
+    return 0;
+}
+
+/** @brief report the overruns of the running thread under OVERRUN_NOTIFY
+ *
+ *  A job which overran runs on in the background, the thread may call this
+ *  from time to time to cut the job short.
+ *
+ *  @return     the overruns since the last call, which are cleared
+ */
+
+uint32_t sys_thread_overrun() {
+    tcb_t* self = &TCB[currentRunningThreadID];
+
+    // the scheduler counts overruns from the PendSV
+    int interrupt_status = save_interrupt_state_and_disable();
+    uint32_t overruns = self->overrun_pending;
+    self->overrun_pending = 0;
+    restore_interrupt_state(interrupt_status);
+
+    return overruns;
+}
+
+/** @brief get the total elapsed time for the running thread 
+ * 
+ * @param no input parameters
+ * 
+ * @return value cumulative time that the thread has been executing
+ * 
+ **/
+
+uint32_t sys_thread_time() {
+    if (tickless) {
+        tickless_catch_up();
+    }
+    return TCB[currentRunningThreadID].time_since_scheduler_start;
+}
+
+/** @brief kill the running thread
+ *
+ *  @note  locks if main or idle thread is running, mutexes it holds go to their waiters
+ *
+ *  @return does not return
+ */
+
+void print_tcb(tcb_t* tcb_list) {
+    tcb_t* temp = tcb_list;
+
+    while(temp != NULL) {
+        printk("%p=>", temp);
+        temp = temp->next;
+    }
+}
+
+/**
+ * 
+ * @brief Stops a user thread for good, gives its TCB and stacks back and wakes its joiners with
+ * the exit code. A thread other than the running one is taken off whatever timer or wait queue
+ * it is in. When the running thread is killed the caller switches away, from a handler the next
+ * scheduling decision does.
+ * 
+ * @param[in] pointer to the tcb of the thread
+ * @param[in] exit code passed to the joiners
+ * 
+ * @return none
+ * 
+ **/
+
+static void thread_kill(tcb_t* tcb, int32_t exit_code) {
+    // atomic against other creates and kills, the tcb leaves the tests together with its sums
+    int interrupt_status = save_interrupt_state_and_disable();
+    // a mutex waiter is BLOCKED outside of any wait queue
+    if ((tcb->state == BLOCKED) && (tcb->wait_queue == NULL)) {
+        mutex_wait_remove(tcb);
+    }
+    thread_set_state(tcb, STOPPED);
+    live_threads--;
+    admission_remove(tcb);
+
+    // a thread killed inside a critical section gives its mutexes to their waiters, or the
+    // system ceiling would never drop again
+    while (tcb->acquired_mutexes != NULL) {
+        mutex_hand_over(tcb->acquired_mutexes);
+    }
+    mutex_requeue_handoff(tcb);
+
+    timer_queue_remove(&release_queue, &tcb->release_timer);
+    timer_queue_remove(&timeout_queue, &tcb->wait_timer);
+    wait_queue_remove(tcb);
+    if (console_server == tcb) {
+        console_server = NULL;
+    }
+    // nothing is written to the freed stacks, so the kernel stack stays usable until the switch
+    thread_stacks_free(tcb);
+    tcb->execution_time = 0;
+    tcb->exit_code = exit_code;
+
+    // the exit code goes with the wake up, the tcb may be reused before a joiner runs
+    while (tcb->joiners != NULL) {
+        thread_wake(tcb->joiners, (uint32_t)exit_code);
+    }
+
+    free_tcb_put(tcb);
+    if(totalThreads > 1) {
+        totalThreads--;
+    }
+    restore_interrupt_state(interrupt_status);
+}
+
+void sys_thread_kill() {
+    printk("Killing the thread %lu\n", currentRunningThreadID);
+    sys_thread_exit(0);
+}
+
+/** @brief end the running thread with an exit code for its joiners
+ *
+ *  The main thread ends the program with the exit code instead.
+ *
+ *  @param exit_code    returned by sys_thread_join
+ *
+ *  @return does not return
+ */
+
+void sys_thread_exit(int32_t exit_code) {
+    if ((currentRunningThreadID != MAIN_THREAD_ID) && (currentRunningThreadID != IDLE_THREAD_ID)) {
+        thread_kill(&TCB[currentRunningThreadID], exit_code);
+    }
+    
+    // if currentRunningThreadID = 0, call sysexit
+    if (currentRunningThreadID == 0) {
+        // call sysexit here
+        // systick_stop();
+        sys_exit(exit_code);
+    }
+    pend_pendsv();
+    // if currentRunningThreadID = IDLE_THREAD_ID, call default_idle, psp->lr for idle thread is set to default_idle
+}
+
+/** @brief kill a thread by ID, its exit code is THREAD_EXIT_KILLED
+ *
+ *  The thread stops wherever it is, ready, waiting for its period, asleep or
+ *  blocked on a semaphore, event, message queue or mutex. As on an overrun
+ *  kill, the mutexes it holds are unlocked and handed over to their waiters,
+ *  and an owner it was blocked by drops the priority inherited from it.
+ *
+ *  @param tid      ID of the thread, the running thread kills itself
+ *
+ *  @return     0 for success, -1 if there is no such thread
+ */
+
+int sys_thread_kill_tid(uint32_t tid) {
+    if ((tid == MAIN_THREAD_ID) || (tid >= IDLE_THREAD_ID)) {
+        return -1;
+    }
+
+    if (tid == currentRunningThreadID) {
+        sys_thread_exit(THREAD_EXIT_KILLED);
+        return 0;
+    }
+
+    tcb_t* tcb = &TCB[tid];
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if (tcb->state == STOPPED) {
+        restore_interrupt_state(interrupt_status);
+        return -1;
+    }
+
+    thread_kill(tcb, THREAD_EXIT_KILLED);
+    restore_interrupt_state(interrupt_status);
+
+    // the ready set changed, let the scheduler decide again
+    pend_pendsv();
+    return 0;
+}
+
+/** @brief wait until a thread exits
+ *
+ *  A thread which already exited is joined at once, its exit code is kept
+ *  until its TCB is reused by a later create. Any number of threads may join
+ *  the same thread.
+ *
+ *  @param tid          ID of the thread
+ *  @param exit_code    where to store its exit code, may be NULL
+ *
+ *  @return     0 for success, -1 if called from main or idle or for the caller itself
+ */
+
+int sys_thread_join(uint32_t tid, int32_t* exit_code) {
+    if ((currentRunningThreadID == MAIN_THREAD_ID) || (currentRunningThreadID == IDLE_THREAD_ID)) {
+        return -1;
+    }
+
+    if ((tid == MAIN_THREAD_ID) || (tid >= IDLE_THREAD_ID) || (tid == currentRunningThreadID)) {
+        return -1;
+    }
+
+    tcb_t* tcb = &TCB[tid];
+    int32_t code;
+
+    int interrupt_status = save_interrupt_state_and_disable();
+    if (tcb->state == STOPPED) {
+        code = tcb->exit_code;
+        restore_interrupt_state(interrupt_status);
+    }
+    else {
+        code = (int32_t)thread_wait(&tcb->joiners, WAIT_FOREVER, interrupt_status);
+    }
+
+    if (exit_code != NULL) {
+        *exit_code = code;
+    }
+    return 0;
+}
+
+/** @brief deschedule thread and wait until next turn 
+ * 
+ * @param no input parameters
+ * 
+ * @return no return value
+ * 
+ **/
+
+
+void sys_wait_until_next_period() {
+    // set the thread to waiting then immediately pend
+    // a PendSV to run the scheduler. This will swap the thread out immediately, without waiting for the next SysTick.
+    // make current thread waiting state
+    // make scheduler wait till next interrupt
+    thread_set_state(&TCB[currentRunningThreadID], WAITING);
+    TCB[currentRunningThreadID].execution_time = 0;
+    TCB[currentRunningThreadID].svc_status = 0;
+    pend_pendsv(); 
+    wait_for_interrupt();
+}
+
+/** @brief sporadic server only, wait until an event arrives
+ *
+ *  The server is descheduled while no event is pending, the budget it consumed
+ *  since it became active is replenished one period after it became active.
+ *
+ *  @return     the SERVER_EVENT_* bits which arrived, -1 if the caller is not a server
+ */
+
+int sys_server_wait() {
+    tcb_t* tcb = &TCB[currentRunningThreadID];
+
+    if (tcb->type != THREAD_TYPE_SERVER) {
+        return -1;
+    }
+
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    while (tcb->server.pending == 0) {
+        tcb->server.idle = 1;
+        thread_set_state(tcb, WAITING);
+        pend_pendsv();
+        // the PendSV switches away as soon as interrupts are enabled, and returns here once
+        // server_signal has woken the server
+        restore_interrupt_state(interrupt_status);
+        interrupt_status = save_interrupt_state_and_disable();
+    }
+
+    uint32_t events = tcb->server.pending;
+    tcb->server.pending = 0;
+
+    restore_interrupt_state(interrupt_status);
+    return (int)events;
+}
+
+/** @brief signal a sporadic server, safe to call from interrupt handlers
+ *
+ *  @param tid      ID of the server thread
+ *
+ *  @return     0 for success, -1 for failure
+ */
+
+int sys_server_post(uint32_t tid) {
+    if ((tid == MAIN_THREAD_ID) || (tid >= IDLE_THREAD_ID) ||
+        (TCB[tid].state == STOPPED) || (TCB[tid].type != THREAD_TYPE_SERVER)) {
+        return -1;
+    }
+
+    server_signal(&TCB[tid], SERVER_EVENT_POST);
+    return 0;
+}
+
+/**
+ * 
+ * @brief This function is used to initialise  mutex in the system. It accepts the max prio
+ * ceiling of the thread that will be using it. The kernel will not be doing any kind
+ * of checking in this function.
+ * 
+ * @param in max prio of the thread that will use the mutex
+ * 
+ * @return pointer to the mutex on success and NULL on failure
+ * 
+ **/
+
+
+kmutex_t* sys_mutex_init(uint32_t max_prio) {
+    if ((last_mutex >= MAX_MUTEXES) || ((uint32_t)last_mutex >= max_mutexes)) {
+        return NULL;
+    }
+
+    if (max_prio >= BACKGROUND_PRIORITY) {
+        printk("Mutex ceiling must be less than %d\n", BACKGROUND_PRIORITY);
+        return NULL;
+    }
+
+    MU[last_mutex].locked_by = __UINT32_MAX__;
+    MU[last_mutex].prio_ceil = max_prio;
+    MU[last_mutex].owner = NULL;
+    MU[last_mutex].next = NULL;
+    MU[last_mutex].prev = NULL;
+    MU[last_mutex].owned_next = NULL;
+    MU[last_mutex].waiting_threads = NULL;
+    return &MU[last_mutex++];
+}
+
+/**
+ * 
+ * @brief Returns the locked mutex with the highest priority ceiling, two clz on the ceiling
+ * bitmap whatever the number of mutexes.
+ * 
+ * @param[in] none
+ * 
+ * @return pointer to the mutex, NULL if no mutex is locked
+ * 
+ **/
+
+kmutex_t* find_highest_priority_ceiling() {
+    if (ceiling_group == 0) {
+        return NULL;
+    }
+
+    uint32_t word = count_leading_zeros(ceiling_group);
+    uint32_t level = (word << 5) + count_leading_zeros(ceiling_bitmap[word]);
+
+    return ceiling_head[level];
+}
+/**
+ * 
+ * @brief this function is used to lock a mutex when a thread has to execute a critical section.
+ * 
+ * @param takes in a pointer to the mutex that the thread wants to lock
+ * 
+ * @return no return value
+ * 
+ **/
+
+
+void sys_mutex_lock(kmutex_t* mutex) {
+
+    tcb_t* self = &TCB[currentRunningThreadID];
+
+    if(TCB[currentRunningThreadID].static_priority < mutex->prio_ceil) {
+        // printk("You cannot acquire this mutex dear thread, you are of low priority.!\n");
+        sys_thread_kill();
+        // the tcb is freed already, the switch away happens once the SVC returns
+        return;
+    }
+
+    if (mutex->owner == &TCB[currentRunningThreadID]) {
+        printk("WARNING (sys_mutex_lock): Lock already acquired by the same thread %lu\n", currentRunningThreadID - 1);
+        return;
+    }
+     
+        
+        kmutex_t* highest_priority_ceiling_m = find_highest_priority_ceiling();
+
+    
+
+        while((highest_priority_ceiling_m!= NULL) 
+        && (self->dynamic_priority >= highest_priority_ceiling_m->prio_ceil) 
+        && (highest_priority_ceiling_m->owner != self)
+        ){
+            // wait on the mutex which sets the ceiling, its unlock hands over to the first waiter
+            int interrupt_status = save_interrupt_state_and_disable();
+            mutex_wait_insert(highest_priority_ceiling_m, self);
+            thread_set_state(self, BLOCKED);
+
+            // the ceiling owner inherits the priority of the threads it blocks
+            tcb_t* owner = highest_priority_ceiling_m->owner;
+            if(owner->dynamic_priority > self->dynamic_priority)
+                thread_set_dynamic_priority(owner, self->dynamic_priority);
+            restore_interrupt_state(interrupt_status);
+
+            mutex_requeue_handoff(self);
+            
+            pend_pendsv();
+            
+            highest_priority_ceiling_m = find_highest_priority_ceiling();
+
+        }        
+
+    //printk("Got the lock(%p) by thread %lu\n",mutex, currentRunningThreadID);
+    
+    int interrupt_status = save_interrupt_state_and_disable();
+    mutex->owner = self;
+    mutex->locked_by = currentRunningThreadID;
+    mutex->owned_next = self->acquired_mutexes;
+    self->acquired_mutexes = mutex;
+    ceiling_push(mutex);
+    restore_interrupt_state(interrupt_status);
+    trace_event(TRACE_MUTEX_LOCK, mutex - MU);
+
+    // waiters handed over with the ceiling now queue behind the mutex just taken
+    mutex_requeue_handoff(self);
+
+    return;
+}
+
+/**
+ * 
+ * @brief this function is used to unlock a mutex when a thread is done executing a critical section.
+ * 
+ * @param takes in a pointer to the mutex that the thread wants to unlock
+ * 
+ * @return no return value
+ * 
+ **/
+
+void sys_mutex_unlock(kmutex_t* mutex) {
+    tcb_t* waiter = NULL;
+
+    if (mutex->owner == NULL) {
+        printk("WARNING (sys_mutex_unlock): Mutex is free, cannot be unlocked again\n");
+        // pend_pendsv();
+    }
+    else {
+        trace_event(TRACE_MUTEX_UNLOCK, mutex - MU);
+        // hand over to the highest priority waiter only, it takes the rest of the queue along
+        int interrupt_status = save_interrupt_state_and_disable();
+        tcb_t* owner = mutex->owner;
+        waiter = mutex_hand_over(mutex);
+        // waiters of the mutexes still held keep the owner boosted
+        thread_set_dynamic_priority(owner, mutex_owner_priority(owner));
+        restore_interrupt_state(interrupt_status);
+    }
+
+
+    //TODO : Now once a mutex has been released by a task, then should we wait for all the mutexes 
+    // held by this task to be released? Or can we proceed with scheduling the next one?
+
+    //printk("Unlocked the lock(%p) by thread %lu\n",mutex, currentRunningThreadID);
+
+    if (sched_policy == SCHED_POLICY_EDF) {
+        // the system ceiling dropped, an earlier deadline thread may be allowed to run now
+        pend_pendsv();
+    }
+    else if ((waiter != NULL) && (waiter->dynamic_priority < TCB[currentRunningThreadID].dynamic_priority)) {
+        // switch to the waiter right away rather than at the next scheduler tick
+        pend_pendsv();
+    }
+
+    // TCB[currentRunningThreadID].dynamic_priority = TCB[currentRunningThreadID].static_priority;
+    // pend_pendsv();
+    //append_mutex_list(free_mutex_list, mutex);
+}
+
+/**
+ * 
+ * @brief Ends the current job of a periodic thread, which waits for its next release.
+ * 
+ * @param[in] pointer to the tcb
+ * @param[in] non zero if the job was stopped because it ran out of budget
+ * 
+ * @return none
+ * 
+ **/
+
+static void thread_job_end(tcb_t* tcb, int overrun) {
+    stats_job_end(tcb, overrun);
+    tcb->overrun_background = 0;
+    thread_set_dynamic_priority(tcb, tcb->static_priority);
+    thread_set_state(tcb, WAITING);
+    tcb->execution_time = 0;
+    tcb->job_cycles = 0;
+}
+
+/**
+ * 
+ * @brief Handles a job of the running thread which has used up its budget C, by the overrun
+ * policy of the thread. In table mode a job which ran on would take the time of the later slots
+ * of its frame, so it is suspended unless the thread is to be killed.
+ * 
+ * @param[in] pointer to the tcb of the running thread
+ * 
+ * @return none
+ * 
+ **/
+
+static void thread_overrun(tcb_t* tcb) {
+    if (tcb->overrun_policy == OVERRUN_NOTIFY) {
+        tcb->overrun_pending++;
+    }
+
+    if (tcb->overrun_policy == OVERRUN_KILL) {
+        tcb->stats.overruns++;
+        printk("Killing the thread %lu, it overran its budget\n", (uint32_t)(tcb - TCB));
+        thread_kill(tcb, THREAD_EXIT_KILLED);
+    }
+    else if (table_mode || (tcb->overrun_policy == OVERRUN_SUSPEND)) {
+        thread_job_end(tcb, 1);
+    }
+    else {
+        // the job stays active, it completes or misses its deadline as usual
+        tcb->stats.overruns++;
+        tcb->overrun_background = 1;
+        if (sched_policy == SCHED_POLICY_EDF) {
+            thread_set_deadline(tcb, global_system_time + BACKGROUND_DEADLINE);
+        }
+        else if (tcb->dynamic_priority == tcb->static_priority) {
+            // a thread boosted by a mutex keeps the boost, the unlock drops it to the background
+            thread_set_dynamic_priority(tcb, BACKGROUND_PRIORITY);
+        }
+    }
+}
+
+/**
+ * 
+ * @brief RMS scheduler which is used to find the highest priority task based on the time period
+ * of each task.
+ * 
+ * @param[in] none
+ * 
+ * @return returns the ID of the thread 
+ * 
+ **/
+
+uint32_t RMS() {
+    tcb_t* current = &TCB[currentRunningThreadID];
+
+    if((current->type == THREAD_TYPE_SERVER) && (current->state != BLOCKED) && (current->state != SLEEPING) && (current->state != STOPPED) &&
+        ((current->server.budget == 0) || (current->state == WAITING))) {
+        // an exhausted server keeps its work and resumes at the next replenishment
+        if(current->state == WAITING) {
+            stats_job_end(current, 0);
+        }
+        else {
+            current->stats.overruns++;
+        }
+        server_deactivate(current);
+        thread_set_dynamic_priority(current, current->static_priority);
+        thread_set_state(current, WAITING);
+        current->execution_time = 0;
+    }
+    else if((current->type != THREAD_TYPE_SERVER) && (current->state != BLOCKED) && (current->state != SLEEPING) && (current->state != STOPPED)) {
+        if(current->state == WAITING) {
+            thread_job_end(current, 0);
+        }
+        else if(!current->overrun_background && (current->job_cycles >= (uint64_t)current->C * cycles_per_tick)) {
+            thread_overrun(current);
+        }
+    }
+
+    if (live_threads == 0) {
+	// schedule main if all threads died
+        return MAIN_THREAD_ID;
+    } 
+
+    if (table_mode) {
+        return table_next();
+    }
+
+    if (sched_policy == SCHED_POLICY_EDF) {
+        return EDF();
+    }
+
+    if (ready_group == 0) {
+        return IDLE_THREAD_ID;
+    }
+
+    // the highest priority level with a ready thread is the leading set bit
+    uint32_t word = count_leading_zeros(ready_group);
+    uint32_t level = (word << 5) + count_leading_zeros(ready_bitmap[word]);
+
+    // printk("The next highest priority task is %lu\n", ready_head[level] - TCB);
+
+    return (uint32_t)(ready_head[level] - TCB);
+
+}
+
+/**
+ * 
+ * @brief EDF scheduler, picks the ready thread with the earliest absolute deadline. Under the
+ * stack resource policy a thread may only run if its static priority (its preemption level) is
+ * above the ceiling of every locked mutex, or if it owns the mutex which sets the ceiling. With
+ * the ceilings respected a thread never finds a mutex locked, so sys_mutex_lock does not block.
+ * 
+ * @param[in] none
+ * 
+ * @return returns the ID of the thread 
+ * 
+ **/
+
+uint32_t EDF() {
+    kmutex_t* ceiling_m = find_highest_priority_ceiling();
+    uint32_t ceiling = (ceiling_m != NULL) ? ceiling_m->prio_ceil : __UINT32_MAX__;
+
+    for (tcb_t* tcb = edf_ready; tcb != NULL; tcb = tcb->rq_next) {
+        if ((tcb->static_priority < ceiling) || (tcb == ceiling_m->owner)) {
+            return (uint32_t)(tcb - TCB);
+        }
+    }
+
+    return IDLE_THREAD_ID;
+}
+
+/**
+ * 
+ * @brief Utilization bound test of the new task against the incremental sums, in O(1) plus one
+ * pass over the live threads to check their priorities. The Liu and Layland bound only holds for
+ * distinct rate monotonic priorities, D = T and no blocking, otherwise only a utilization over 1
+ * is decided here. The rounding of the sums never flips a decision of RTA_test_RMS.
+ * 
+ * @param[in] priority of the task
+ * @param[in] WCET of the task
+ * @param[in] Time period of the task 
+ * @param[in] relative deadline of the task
+ * 
+ * @return 1 if schedulable, -1 if not, 0 if RTA_test_RMS has to decide
+ * 
+ * */
+
+int UB_test_RMS(uint32_t prio, uint32_t C, uint32_t T, uint32_t D) {
+    uint32_t no_threads = live_threads + 1;
+    uint64_t util = util_sum + q32_div(C, T);
+
+    // every term is rounded up by less than one, beyond that the utilization is over 1
+    if(util > Q32_ONE + no_threads) {
+        return -1;
+    }
+
+    if((D != T) || (constrained_threads != 0) || (last_mutex != 0)) {
+        return 0;
+    }
+
+    if(util > ((no_threads < (sizeof(ub_table) / sizeof(ub_table[0]))) ? ub_table[no_threads] : UB_LN2)) {
+        return 0;
+    }
+
+    if((rm_inversions != 0) || (rm_inversions_with(prio, T) != 0)) {
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * 
+ * @brief Response time analysis helper, fetches the timing of slot i of the task set. Slot 0
+ * (the main thread) stands for the new task, the other slots are the user threads.
+ * 
+ * @param[in] slot index
+ * @param[in] timing of the new task
+ * @param[out] timing of the task in the slot
+ * 
+ * @return 1 if the slot holds a task, 0 otherwise
+ * 
+ * */
+
+static int rta_task(uint32_t i, const rta_task_t* candidate, rta_task_t* task) {
+    if(i == MAIN_THREAD_ID) {
+        *task = *candidate;
+        return 1;
+    }
+
+    if(TCB[i].state == STOPPED) {
+        return 0;
+    }
+
+    task->prio = TCB[i].static_priority;
+    task->C = TCB[i].C;
+    task->T = TCB[i].T;
+    task->D = TCB[i].D;
+    return 1;
+}
+
+/**
+ * 
+ * @brief Exact response time analysis of the fixed priority task set with the new task added.
+ * Every task must finish within its relative deadline in the worst case, which is its own
+ * WCET, one critical section of a lower priority task (taken as its whole WCET) if any mutex
+ * ceiling reaches the task's priority, and the preemptions by tasks of higher or equal priority.
+ * Threads of equal priority share a FIFO ready list so they are counted as interference.
+ * 
+ * @param[in] priority of the task
+ * @param[in] WCET of the task
+ * @param[in] Time period of the task 
+ * @param[in] relative deadline of the task
+ * 
+ * @return 0 if schedulable, -1 otherwise
+ * 
+ * */
+
+int RTA_test_RMS(uint32_t prio, uint32_t C, uint32_t T, uint32_t D) {
+    // the new task takes the place of the main thread, every other slot is a live user thread
+    rta_task_t candidate = { .prio = prio, .C = C, .T = T, .D = D };
+    rta_task_t task_i, task_j;
+    uint32_t min_ceiling = __UINT32_MAX__;
+
+    for(int m = 0; m < last_mutex; m++) {
+        if(MU[m].prio_ceil < min_ceiling) {
+            min_ceiling = MU[m].prio_ceil;
+        }
+    }
+
+    for(uint32_t i = 0; i < IDLE_THREAD_ID; i++) {
+        if(!rta_task(i, &candidate, &task_i)) {
+            continue;
+        }
+
+        uint32_t blocking = 0;
+
+        if(min_ceiling <= task_i.prio) {
+            for(uint32_t k = 0; k < IDLE_THREAD_ID; k++) {
+                if(rta_task(k, &candidate, &task_j) && (task_j.prio > task_i.prio) && (task_j.C > blocking)) {
+                    blocking = task_j.C;
+                }
+            }
+        }
+
+        // iterate R = C + B + sum(ceil(R / Tj) * Cj) to its fixed point, or until it misses D
+        uint32_t response = task_i.C + blocking;
+        uint32_t previous = 0;
+
+        while((response != previous) && (response <= task_i.D)) {
+            previous = response;
+            response = task_i.C + blocking;
+
+            for(uint32_t j = 0; j < IDLE_THREAD_ID; j++) {
+                if((j != i) && rta_task(j, &candidate, &task_j) && (task_j.prio <= task_i.prio)) {
+                    response += ((previous + task_j.T - 1) / task_j.T) * task_j.C;
+                }
+            }
+        }
+
+        if(response > task_i.D) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * 
+ * @brief Used to perform the EDF density test, the task set is schedulable as long as the sum
+ * of C / D including the new task does not exceed 1. With D = T this is the exact utilization
+ * test. O(1) in fixed point against the density sum of the live threads.
+ * 
+ * @param[in] WCET of the task
+ * @param[in] relative deadline of the task
+ * 
+ * @return 0 if schedulable, -1 otherwise
+ * 
+ * */
+
+int UB_test_EDF(uint32_t C, uint32_t D) {
+    if(D == 0) {
+        return -1;
+    }
+
+    // every term is rounded up by less than one, a set within that of 1 is admitted
+    if(density_sum + q32_div(C, D) > Q32_ONE + live_threads + 1) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * 
+ * @brief This function is used to read the lux sensor. This is a system call which gets
+ * called when the stub for the specific user function is pressed. 
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_read_lux() {
+    // printk("entered read lux\n");
+
+    uint8_t txbuffer1[3] = {0x00, 0x00, 0x00};
+
+	int i2c;
+	i2c = i2c_leader_write(txbuffer1, 3, 0x10);
+
+	i2c_leader_stop();
+
+	if(i2c == -1) {
+		printk("Write failed\n");
+	}
+
+	uint8_t txbuffer2[1]= {0x04};
+
+	i2c = i2c_leader_write(txbuffer2, 1, 0x10);
+
+	if(i2c == -1) {
+		printk("Write failed\n");
+	}
+
+	uint8_t rxbuffer[2] = {0};
+
+	int i2c_ = i2c_leader_read(rxbuffer, 2, 0x10);
+
+	i2c_leader_stop();
+	if(i2c_ == -1) {
+		printk("Read failed\n");
+	}
+
+	uint16_t result_ = 0;
+    (void)result_;
+    result_ = rxbuffer[0] | (rxbuffer[1] << 8);
+
+    // printk("I read %d from lux\n", result_);
+}
+
+/**
+ * 
+ * @brief This function is used to read the microphone. This is a system call which gets
+ * called when the stub for the specific user function is pressed. 
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_read_mic() {
+    // printk("entered mic lux\n");
+    adc_read_pin();
+}
+
+/**
+ * 
+ * @brief This function is system call which is used to glow the led. This is called
+ * via a stub from the user space function.
+ * 
+ * @param[in] If the user gives 0 then the leds turn off. Else, then remain on.
+ * 
+ * @return none
+ * 
+ */
+
+void sys_glow_led(int on) {
+    glow_led(on);
+}
+
+
+/**
+ * 
+ * @brief This function is used to move the car forward. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_move_forward(void) {
+    pwm_actuate_forward();
+}
+
+
+/**
+ * 
+ * @brief This function is used to move the car backward. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_move_backward(void) {
+
+    pwm_actuate_backward();
+}
+
+
+/**
+ * 
+ * @brief This function is used to move the car left. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_turn_left(void) {
+
+    pwm_actuate_left();
+}
+
+
+/**
+ * 
+ * @brief This function is used to move the car right. This is the system call that does
+ * the propulsion. It calls another pwm helper function to actuate the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_turn_right(void) {
+    pwm_actuate_right();
+}
+
+
+/**
+ * 
+ * @brief This function is used to stop the car. It calls another pwm helper function to stop the motors.
+ * 
+ * @params[in] none
+ * 
+ * @return none
+ * 
+ */
+
+void sys_stop_car(void) {
+    pwm_stop();
+}
+
+
@@ -10,10 +10,14 @@
 #include <timer.h>
 #include <unistd.h>
 #include<arm.h>
+#include<gpio.h>
+#include<syscall_thread.h>
+#include <trace.h>
 
-#define PROC_FREQ 64000000
 
 volatile systick_t* timer = (systick_t*)0xE000E010;
+oneshot_timer_t* oneshot = (oneshot_timer_t*)ONESHOT_TIMER;
+extern volatile nvic_iser_t* iser;
 
 /**
  * 
@@ -51,4 +55,102 @@ void systick_stop() {
 	timer->SYST_RVR = 0;
 	timer->SYST_CSR &= (~ENABLE);
 	timer->SYST_CVR = 0;
-}
\ No newline at end of file
+}
+
+/**
+ * 
+ * @brief Starts the one shot timer as a free running 32 bit counter at ONESHOT_TIMER_FREQ.
+ * The interrupt gets the same priority as SysTick and PendSV so that the tick logic is never
+ * preempted by a context switch.
+ * 
+ * @param[in] none
+ * 
+ * @return does not return
+ * 
+ **/
+
+void oneshot_timer_start() {
+    oneshot->tasks_stop = 1;
+    oneshot->mode = 0;
+    oneshot->bitmode = ONESHOT_TIMER_BITMODE_32;
+    oneshot->prescaler = ONESHOT_TIMER_PRESCALER;
+    oneshot->tasks_clear = 1;
+    oneshot->events_compare[0] = 0;
+    oneshot->intenset = ONESHOT_TIMER_INT_COMPARE0;
+
+    ((volatile uint8_t*)NVIC_IPR)[ONESHOT_TIMER_EXCEPTION_NUMBER] = 0x20;
+    iser->iser0 |= (1 << ONESHOT_TIMER_EXCEPTION_NUMBER);
+
+    oneshot->tasks_start = 1;
+}
+
+/**
+ * 
+ * @brief Stops the one shot timer and disables its interrupt.
+ * 
+ * @param[in] none
+ * 
+ * @return no return values
+ * 
+ **/
+
+void oneshot_timer_stop() {
+    oneshot->intenclr = ONESHOT_TIMER_INT_COMPARE0;
+    oneshot->tasks_stop = 1;
+    oneshot->events_compare[0] = 0;
+    *NVIC_ICER = (1 << ONESHOT_TIMER_EXCEPTION_NUMBER);
+}
+
+/**
+ * 
+ * @brief Reads the current value of the free running counter.
+ * 
+ * @param[in] none
+ * 
+ * @return counter value in ONESHOT_TIMER_FREQ units
+ * 
+ **/
+
+uint32_t oneshot_timer_now() {
+    oneshot->tasks_capture[1] = 1;
+    return oneshot->cc[1];
+}
+
+/**
+ * 
+ * @brief Arms the compare interrupt for an absolute counter value. If the value has already
+ * passed by the time it is armed the interrupt is pended straight away, otherwise the compare
+ * would only match after the counter wraps.
+ * 
+ * @param[in] absolute counter value at which to interrupt
+ * 
+ * @return no return values
+ * 
+ **/
+
+void oneshot_timer_set(uint32_t count) {
+    oneshot->events_compare[0] = 0;
+    oneshot->cc[0] = count;
+
+    if ((int32_t)(count - oneshot_timer_now()) <= 0) {
+        *NVIC_ISPR = (1 << ONESHOT_TIMER_EXCEPTION_NUMBER);
+    }
+}
+
+/**
+ * 
+ * @brief Interrupt handler of the one shot timer, the compare event is acknowledged and the
+ * scheduler catches up on the ticks which elapsed since it last ran.
+ * 
+ * @param[in] none
+ * 
+ * @return no return values
+ * 
+ **/
+
+void TIMER1_IRQHandler() {
+    trace_isr_enter();
+    oneshot->events_compare[0] = 0;
+    tickless_c_handler();
+    trace_isr_exit();
+}
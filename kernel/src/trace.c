@@ -0,0 +1,66 @@
+/** @file   trace.c
+ *
+ *  @brief  writes trace records to the RTT trace channel, see trace.h
+**/
+
+#include <arm.h>
+#include <rtt.h>
+#include <trace.h>
+
+#ifdef TRACE
+
+extern volatile uint32_t currentRunningThreadID;
+
+/** @brief records dropped since the last one which fit */
+static uint32_t trace_dropped = 0;
+
+/**
+ *
+ * @brief Writes a trace record for a thread. Safe to call from any exception handler, the record
+ * is dropped if the trace channel is full.
+ *
+ * @param[in] TRACE_* record type
+ * @param[in] thread id
+ * @param[in] record argument, see the record types
+ *
+ * @return does not return any value
+ *
+ **/
+
+void trace_thread_event(uint32_t type, uint32_t tid, uint32_t arg) {
+    trace_record_t record;
+
+    // exceptions nest, a record must be stamped and written in one go
+    int interrupt_status = save_interrupt_state_and_disable();
+
+    record.cycles = get_cycle_count();
+    record.tid = (uint8_t)tid;
+
+    if (trace_dropped != 0) {
+        record.type = TRACE_DROPPED;
+        record.arg = (trace_dropped > 0xFFFF) ? 0xFFFF : (uint16_t)trace_dropped;
+
+        if (rtt_write_nonblocking(RTT_TRACE_BUFFER, &record, sizeof(record)) == 0) {
+            trace_dropped++;
+            restore_interrupt_state(interrupt_status);
+            return;
+        }
+        trace_dropped = 0;
+    }
+
+    record.type = (uint8_t)type;
+    record.arg = (uint16_t)arg;
+
+    if (rtt_write_nonblocking(RTT_TRACE_BUFFER, &record, sizeof(record)) == 0) {
+        trace_dropped++;
+    }
+
+    restore_interrupt_state(interrupt_status);
+}
+
+/** @brief same as trace_thread_event for the running thread */
+void trace_event(uint32_t type, uint32_t arg) {
+    trace_thread_event(type, currentRunningThreadID, arg);
+}
+
+#endif /* TRACE */
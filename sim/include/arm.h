@@ -0,0 +1,110 @@
+/** @file   arm.h
+ *
+ *  @brief  host replacement of kernel/include/arm.h for the simulator
+ *
+ *  Same interface as the kernel header. Interrupt masking, the PendSV and
+ *  the cycle counter are simulated by sim_hw.c, see sim.h.
+**/
+#ifndef _ARM_H_
+#define _ARM_H_
+
+#include <stdint.h>
+#include <unistd.h>
+
+#define intrinsic __attribute__((always_inline)) static inline
+#define BUSY_LOOP(COND) while (COND)
+
+/** @brief simulated PRIMASK, non zero while interrupts are disabled */
+extern volatile int sim_primask;
+/** @brief simulated cycle counter */
+extern volatile uint32_t sim_cycles;
+
+/** @brief see sim.h, called before interrupts are disabled while they are enabled */
+extern void (*sim_interrupt_hook)();
+
+void sim_interrupts_enabled();
+
+void init_align_prio();
+void enable_prefetch_i_cache();
+void enable_fpu();
+void pend_pendsv();
+void clear_pendsv();
+int get_svc_status();
+void set_svc_status(int status);
+void set_enable_memfault();
+void enable_cycle_counter();
+
+/** @brief simulated DWT cycle count register */
+#define DWT_CYCCNT (&sim_cycles)
+
+/** @brief no debugger to stop, abort instead */
+intrinsic void breakpoint(){
+    __builtin_trap();
+}
+
+/** @brief the simulator only waits in the idle thread, see default_idle() in sim_hw.c */
+intrinsic void wait_for_interrupt(){
+}
+
+/** @brief enable interrupts */
+intrinsic void enable_interrupts(){
+    sim_primask = 0;
+    sim_interrupts_enabled();
+}
+
+/** @brief disable interrupts */
+intrinsic void disable_interrupts(){
+    sim_primask = 1;
+}
+
+/** @brief data synchronization memory barrier */
+intrinsic void data_sync_barrier() {
+    __sync_synchronize();
+}
+
+/** @brief instruction synchronization barrier */
+intrinsic void instruction_sync_barrier() {
+    __sync_synchronize();
+}
+
+/** @brief store exclusive, the simulator runs one thread at a time so it always succeeds */
+intrinsic uint32_t store_exclusive(uint32_t *addr, uint32_t val) {
+    *addr = val;
+    return 0;
+}
+
+/** @brief load exclusive */
+intrinsic uint32_t load_exclusive(uint32_t *addr) {
+    return *addr;
+}
+
+/** @brief count leading zeros, returns 32 for 0 */
+intrinsic uint32_t count_leading_zeros(uint32_t val) {
+    return (val == 0) ? 32 : (uint32_t)__builtin_clz(val);
+}
+
+/** @brief read the simulated cycle counter */
+intrinsic uint32_t get_cycle_count() {
+    return *DWT_CYCCNT;
+}
+
+/** @brief saves interrupt enabled state and disables interrupts */
+intrinsic int save_interrupt_state_and_disable() {
+    int result = sim_primask;
+    if (!result && (sim_interrupt_hook != NULL)) {
+        sim_interrupt_hook();
+    }
+    sim_primask = 1;
+    return result;
+}
+
+/** @brief restores saved interrupt enable state, a pending PendSV runs once enabled */
+intrinsic void restore_interrupt_state(int state) {
+    sim_primask = state;
+    if (!state) {
+        sim_interrupts_enabled();
+    }
+}
+
+#undef intrinsic
+#endif /* _ARM_H_ */
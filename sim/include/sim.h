@@ -0,0 +1,70 @@
+/** @file   sim.h
+ *
+ *  @brief  host simulation of the hardware under the kernel scheduler
+ *
+ *  kernel/src/syscall_thread.c is built unchanged for Linux. Every kernel
+ *  thread is a ucontext coroutine, the PendSV switches coroutines and the
+ *  SysTick fires whenever the running thread has used up one tick of CPU
+ *  through sim_compute(). Like on the board a pended PendSV runs as soon as
+ *  interrupts are enabled outside of the SysTick handler, so kernel calls
+ *  block, preempt and hand over exactly where they do on the board. Kernel
+ *  calls themselves take no simulated time.
+**/
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stdint.h>
+#include <syscall_thread.h>
+
+/** @brief blocking seen by one thread */
+typedef struct {
+  uint32_t total; // ticks a lower priority thread ran while this one was ready or blocked /
+  uint32_t max; // most such ticks in one job /
+  uint32_t job; // such ticks of the current job /
+} sim_blocking_t;
+
+/** @brief set to stop printk output */
+extern int sim_quiet;
+
+/**
+ * @brief      When set, called by save_interrupt_state_and_disable whenever
+ *             interrupts were enabled, the last point an interrupt handler
+ *             could preempt the kernel before its critical section. The
+ *             simulator never sets it, tests use it to run a kernel call in
+ *             the middle of another one.
+ */
+extern void (*sim_interrupt_hook)();
+
+/** @brief blocking of every thread, indexed like TCB */
+extern sim_blocking_t sim_blocking[NUM_TCBS];
+
+/**
+ * @brief      Initializes the simulated hardware and the kernel threads, see
+ *             sys_thread_init.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int sim_init(uint32_t max_threads, uint32_t max_mutexes, uint32_t policy);
+
+/**
+ * @brief      Starts the scheduler, see sys_scheduler_start, and returns once
+ *             every thread exited or after ticks scheduler ticks. Tickless
+ *             mode is not simulated.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int sim_run(uint32_t frequency, uint32_t ticks, uint32_t mode);
+
+/**
+ * @brief      Thread context only, uses ticks scheduler ticks of CPU. The
+ *             thread may be preempted at every tick.
+ */
+void sim_compute(uint32_t ticks);
+
+/**
+ * @brief      The current simulated time in ticks.
+ */
+uint32_t sim_now();
+
+#endif /* _SIM_H_ */
@@ -0,0 +1,429 @@
+/** @file   sim.c
+ *
+ *  @brief  runs a task set file on the simulated kernel and reports the
+ *          timing of every task
+ *
+ *  A task set has one task per line, highest priority first:
+ *
+ *      C T [D=<deadline>] [P=<phase>] [E=<work>] [O=<policy>] [S<mutex>:<lock>-<unlock> ...]
+ *
+ *  All times are in scheduler ticks. C is the budget the kernel admits and
+ *  enforces. Every job computes for E ticks, C - 1 by default since a job
+ *  still running when its C-th tick is charged is descheduled as an
+ *  overrun. O= sets what happens on an overrun: suspend (the default),
+ *  background, notify or kill, see the OVERRUN_* policies. A notified job
+ *  drops the work it has left after its sections. P= releases the jobs
+ *  that many ticks after every multiple of T. A section
+ *  S<m>:<a>-<b> holds mutex m from a to b ticks into the job, each mutex
+ *  gets the priority ceiling of its highest priority user.
+ *  "hz <frequency>" sets the tick frequency, "#" starts a comment.
+ *
+ *  "minor <ticks>" followed by one "frame [<tid> ...]" line per minor frame
+ *  runs the tasks from that schedule table (SCHED_MODE_TABLE) instead, task
+ *  n being thread n + 1. util/sched_table_gen.py --sim writes these lines.
+ *
+ *  Blocking is counted against the task order, under EDF it includes every
+ *  tick a task later in the set ran while an earlier one was ready.
+**/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <syscall_mutex.h>
+#include <syscall_thread.h>
+#include <sim.h>
+
+/** @brief the most critical sections in one task */
+#define MAX_SECTIONS 8
+
+/** @brief default number of ticks to simulate */
+#define DEFAULT_TICKS 1000000
+
+typedef struct {
+  uint32_t at; // ticks into the job /
+  uint32_t mutex; // index into mutexes /
+  uint8_t lock; // lock or unlock /
+} section_event_t;
+
+typedef struct {
+  uint32_t C; // budget in ticks /
+  uint32_t T; // period in ticks /
+  uint32_t D; // relative deadline in ticks, 0 means T /
+  uint32_t E; // work of every job in ticks /
+  uint32_t overrun; // OVERRUN_* policy /
+  uint32_t phase; // release offset in ticks /
+  uint32_t num_events; // lock and unlock events, sorted by time /
+  section_event_t events[2 * MAX_SECTIONS];
+  uint32_t tid; // TCB index, 0 if the kernel rejected the task /
+} task_t;
+
+extern tcb_t TCB[NUM_TCBS];
+
+static task_t tasks[MAX_THREADS];
+static uint32_t num_tasks = 0;
+static kmutex_t* mutexes[MAX_MUTEXES];
+static uint32_t num_mutexes = 0;
+static uint32_t frequency = 1000;
+static sched_table_t table;
+static int has_table = 0;
+
+/**
+ *
+ * @brief Body of every task, computes the job's work taking and releasing its mutexes on the
+ * way, then waits for the next period.
+ *
+ **/
+
+static void task_job(void* vargp) {
+    task_t* task = &tasks[(uintptr_t)vargp];
+
+    while (1) {
+        uint32_t done = 0;
+
+        for (uint32_t i = 0; i < task->num_events; i++) {
+            section_event_t* event = &task->events[i];
+
+            sim_compute(event->at - done);
+            done = event->at;
+            if (event->lock) {
+                sys_mutex_lock(mutexes[event->mutex]);
+            }
+            else {
+                sys_mutex_unlock(mutexes[event->mutex]);
+            }
+        }
+
+        if (task->overrun == OVERRUN_NOTIFY) {
+            // a job told of its overrun drops the rest of its work
+            while ((done < task->E) && (sys_thread_overrun() == 0)) {
+                sim_compute(1);
+                done++;
+            }
+        }
+        else {
+            sim_compute(task->E - done);
+        }
+        sys_wait_until_next_period();
+    }
+}
+
+/** @brief orders events by time, unlocks before locks at the same time */
+static int event_compare(const void* a, const void* b) {
+    const section_event_t* x = a;
+    const section_event_t* y = b;
+
+    if (x->at != y->at) {
+        return (x->at < y->at) ? -1 : 1;
+    }
+    if (x->lock != y->lock) {
+        return x->lock ? 1 : -1;
+    }
+    return 0;
+}
+
+static const char* overrun_names[] = { "suspend", "background", "notify", "kill" };
+
+static int parse_uint(const char* s, uint32_t* out) {
+    char* end;
+
+    errno = 0;
+    unsigned long value = strtoul(s, &end, 10);
+    if ((errno != 0) || (end == s) || (*end != '\0') || (value > 0xFFFFFFFFUL)) {
+        return -1;
+    }
+    *out = (uint32_t)value;
+    return 0;
+}
+
+/**
+ *
+ * @brief Parses one task line into the next task.
+ *
+ * @return 0 on success or -1 on a malformed line
+ *
+ **/
+
+static int parse_task(char* line, const char* path, int lineno) {
+    task_t* task = &tasks[num_tasks];
+    char* save;
+    char* token;
+    uint32_t field = 0;
+    uint32_t sections = 0;
+    int has_work = 0;
+
+    if (num_tasks >= MAX_THREADS) {
+        fprintf(stderr, "%s:%d: at most %d tasks\n", path, lineno, MAX_THREADS);
+        return -1;
+    }
+    memset(task, 0, sizeof(*task));
+
+    for (token = strtok_r(line, " \t", &save); token != NULL; token = strtok_r(NULL, " \t", &save)) {
+        if (field < 2) {
+            if (parse_uint(token, (field == 0) ? &task->C : &task->T) != 0) {
+                fprintf(stderr, "%s:%d: bad %s '%s'\n", path, lineno, (field == 0) ? "C" : "T", token);
+                return -1;
+            }
+            field++;
+        }
+        else if (strncmp(token, "D=", 2) == 0) {
+            if (parse_uint(token + 2, &task->D) != 0) {
+                fprintf(stderr, "%s:%d: bad deadline '%s'\n", path, lineno, token);
+                return -1;
+            }
+        }
+        else if (strncmp(token, "P=", 2) == 0) {
+            if (parse_uint(token + 2, &task->phase) != 0) {
+                fprintf(stderr, "%s:%d: bad phase '%s'\n", path, lineno, token);
+                return -1;
+            }
+        }
+        else if (strncmp(token, "E=", 2) == 0) {
+            if (parse_uint(token + 2, &task->E) != 0) {
+                fprintf(stderr, "%s:%d: bad work '%s'\n", path, lineno, token);
+                return -1;
+            }
+            has_work = 1;
+        }
+        else if (strncmp(token, "O=", 2) == 0) {
+            uint32_t policy = 0;
+
+            while ((policy <= OVERRUN_KILL) && (strcmp(token + 2, overrun_names[policy]) != 0)) {
+                policy++;
+            }
+            if (policy > OVERRUN_KILL) {
+                fprintf(stderr, "%s:%d: bad overrun policy '%s'\n", path, lineno, token);
+                return -1;
+            }
+            task->overrun = policy;
+        }
+        else if (token[0] == 'S') {
+            uint32_t mutex, lock, unlock;
+            char extra;
+
+            if ((sscanf(token, "S%u:%u-%u%c", &mutex, &lock, &unlock, &extra) != 3) || (lock > unlock)) {
+                fprintf(stderr, "%s:%d: bad section '%s'\n", path, lineno, token);
+                return -1;
+            }
+            if ((mutex >= MAX_MUTEXES) || (sections >= MAX_SECTIONS)) {
+                fprintf(stderr, "%s:%d: at most %d mutexes and %d sections per task\n", path, lineno, MAX_MUTEXES, MAX_SECTIONS);
+                return -1;
+            }
+            task->events[2 * sections] = (section_event_t){ lock, mutex, 1 };
+            task->events[2 * sections + 1] = (section_event_t){ unlock, mutex, 0 };
+            sections++;
+            if (mutex >= num_mutexes) {
+                num_mutexes = mutex + 1;
+            }
+        }
+        else {
+            fprintf(stderr, "%s:%d: unknown field '%s'\n", path, lineno, token);
+            return -1;
+        }
+    }
+
+    if ((field < 2) || (task->C == 0) || (task->T == 0)) {
+        fprintf(stderr, "%s:%d: a task needs C > 0 and T > 0\n", path, lineno);
+        return -1;
+    }
+    if (!has_work) {
+        task->E = task->C - 1;
+    }
+
+    task->num_events = 2 * sections;
+    qsort(task->events, task->num_events, sizeof(section_event_t), event_compare);
+    if ((task->num_events != 0) && (task->events[task->num_events - 1].at > task->E)) {
+        fprintf(stderr, "%s:%d: sections must end within the work of %u ticks\n", path, lineno, task->E);
+        return -1;
+    }
+
+    num_tasks++;
+    return 0;
+}
+
+static int parse_taskset(const char* path) {
+    FILE* f = fopen(path, "r");
+    char line[512];
+    int lineno = 0;
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineno++;
+        line[strcspn(line, "#\r\n")] = '\0';
+
+        char* start = line + strspn(line, " \t");
+        if (*start == '\0') {
+            continue;
+        }
+
+        if (strncmp(start, "minor", 5) == 0) {
+            if ((sscanf(start, "minor %u", &table.minor_ticks) != 1) || has_table) {
+                fprintf(stderr, "%s:%d: bad or second minor frame\n", path, lineno);
+                fclose(f);
+                return -1;
+            }
+            has_table = 1;
+        }
+        else if (strncmp(start, "frame", 5) == 0) {
+            char* save;
+            uint32_t slot = 0;
+
+            if (!has_table || (table.num_frames >= SCHED_TABLE_MAX_FRAMES)) {
+                fprintf(stderr, "%s:%d: frames need a minor line first, at most %d\n", path, lineno, SCHED_TABLE_MAX_FRAMES);
+                fclose(f);
+                return -1;
+            }
+            strtok_r(start, " \t", &save);
+            for (char* token = strtok_r(NULL, " \t", &save); token != NULL; token = strtok_r(NULL, " \t", &save)) {
+                uint32_t tid;
+
+                if ((parse_uint(token, &tid) != 0) || (tid > 255) || (slot >= SCHED_TABLE_FRAME_SLOTS)) {
+                    fprintf(stderr, "%s:%d: bad frame, at most %d thread IDs\n", path, lineno, SCHED_TABLE_FRAME_SLOTS);
+                    fclose(f);
+                    return -1;
+                }
+                table.slots[table.num_frames][slot++] = (uint8_t)tid;
+            }
+            table.num_frames++;
+        }
+        else if (strncmp(start, "hz", 2) == 0) {
+            if ((sscanf(start, "hz %u", &frequency) != 1) || (frequency == 0)) {
+                fprintf(stderr, "%s:%d: bad frequency\n", path, lineno);
+                fclose(f);
+                return -1;
+            }
+        }
+        else if (parse_task(start, path, lineno) != 0) {
+            fclose(f);
+            return -1;
+        }
+    }
+
+    fclose(f);
+    if (num_tasks == 0) {
+        fprintf(stderr, "%s: no tasks\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/** @brief the priority of the highest priority task using the mutex */
+static uint32_t mutex_ceiling(uint32_t mutex) {
+    for (uint32_t i = 0; i < num_tasks; i++) {
+        for (uint32_t e = 0; e < tasks[i].num_events; e++) {
+            if (tasks[i].events[e].mutex == mutex) {
+                return i;
+            }
+        }
+    }
+    return num_tasks;
+}
+
+static void report(uint32_t ticks, double seconds) {
+    printf("%u ticks at %u Hz in %.2f s\n", ticks, frequency, seconds);
+    printf("%-4s %6s %6s %6s %6s %8s %6s %6s %6s %6s %8s %8s %9s %9s\n", "task", "C", "T", "D", "tid",
+           "jobs", "r_min", "r_avg", "r_max", "jitter", "misses", "overruns", "block_max", "block_sum");
+
+    for (uint32_t i = 0; i < num_tasks; i++) {
+        task_t* task = &tasks[i];
+        thread_stats_t stats;
+
+        if (task->tid == 0) {
+            printf("%-4u %6u %6u %6u rejected by the admission test\n", i, task->C, task->T, task->D ? task->D : task->T);
+            continue;
+        }
+        sys_thread_stats(task->tid, &stats);
+
+        printf("%-4u %6u %6u %6u %6u %8u %6u %6u %6u %6u %8u %8u %9u %9u\n", i, task->C, task->T,
+               task->D ? task->D : task->T, task->tid, stats.jobs, stats.jobs ? stats.response_min : 0,
+               stats.response_avg, stats.response_max, stats.jitter, stats.deadline_misses, stats.overruns,
+               sim_blocking[task->tid].max, sim_blocking[task->tid].total);
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [-e] [-n ticks] [-v] taskset\n"
+                    "  -e        earliest deadline first instead of rate monotonic\n"
+                    "  -n ticks  ticks to simulate, default %d\n"
+                    "  -v        show kernel messages\n", name, DEFAULT_TICKS);
+}
+
+int main(int argc, char** argv) {
+    uint32_t ticks = DEFAULT_TICKS;
+    uint32_t policy = SCHED_POLICY_RMS;
+    int opt;
+
+    sim_quiet = 1;
+    while ((opt = getopt(argc, argv, "en:v")) != -1) {
+        switch (opt) {
+            case 'e':
+                policy = SCHED_POLICY_EDF;
+                break;
+            case 'n':
+                if (parse_uint(optarg, &ticks) != 0) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+            case 'v':
+                sim_quiet = 0;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (parse_taskset(argv[optind]) != 0) {
+        return 2;
+    }
+
+    if (sim_init(num_tasks, num_mutexes, policy) != 0) {
+        fprintf(stderr, "sim: thread init failed\n");
+        return 1;
+    }
+
+    for (uint32_t m = 0; m < num_mutexes; m++) {
+        mutexes[m] = sys_mutex_init(mutex_ceiling(m));
+        if (mutexes[m] == NULL) {
+            fprintf(stderr, "sim: mutex init failed\n");
+            return 1;
+        }
+    }
+
+    // a loaded table skips the admission tests
+    if (has_table && (sys_sched_table_set(&table) != 0)) {
+        fprintf(stderr, "sim: the schedule table was rejected\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < num_tasks; i++) {
+        thread_attr_t attr = { tasks[i].C, tasks[i].T, tasks[i].D, THREAD_TYPE_PERIODIC, 0, 0, tasks[i].overrun, tasks[i].phase, 0 };
+
+        if (sys_thread_create_attr(&task_job, i, &attr, (void*)(uintptr_t)i) == 0) {
+            tasks[i].tid = attr.tid;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (sim_run(frequency, ticks, has_table ? SCHED_MODE_TABLE : SCHED_MODE_PERIODIC) != 0) {
+        fprintf(stderr, "sim: scheduler start failed\n");
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    report(sim_now(), (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    return 0;
+}
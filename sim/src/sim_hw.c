@@ -0,0 +1,395 @@
+/** @file   sim_hw.c
+ *
+ *  @brief  simulated exceptions, context switches and peripherals for the
+ *          host build of the scheduler, see sim.h
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include <adc.h>
+#include <arm.h>
+#include <gpio.h>
+#include <i2c.h>
+#include <mpu.h>
+#include <printk.h>
+#include <rtt.h>
+#include <syscall.h>
+#include <syscall_thread.h>
+#include <timer.h>
+#include <sim.h>
+
+/** @brief host stack of every simulated thread */
+#define SIM_STACK_SIZE (64 * 1024)
+
+/** @brief simulated core clock */
+#define SIM_CPU_HZ 64000000
+
+// the linker symbols of the thread stack regions, naturally aligned 32KB each
+__asm__(
+    ".bss\n"
+    ".balign 32768\n"
+    ".globl __thread_u_stacks_limit\n"
+    "__thread_u_stacks_limit:\n"
+    ".skip 32768\n"
+    ".globl __thread_u_stacks_base\n"
+    "__thread_u_stacks_base:\n"
+    ".globl __thread_k_stacks_limit\n"
+    "__thread_k_stacks_limit:\n"
+    ".skip 32768\n"
+    ".globl __thread_k_stacks_base\n"
+    "__thread_k_stacks_base:\n"
+    ".globl __psp_stack_limit\n"
+    "__psp_stack_limit:\n"
+    ".skip 2048\n"
+    ".globl __msp_stack_limit\n"
+    "__msp_stack_limit:\n"
+    ".skip 2048\n"
+    ".text\n"
+);
+
+extern tcb_t TCB[NUM_TCBS];
+extern volatile uint32_t currentRunningThreadID;
+void *pendsv_c_handler(void *msp);
+void systick_c_handler();
+
+volatile int sim_primask = 0;
+volatile uint32_t sim_cycles = 0;
+int sim_quiet = 0;
+void (*sim_interrupt_hook)() = NULL;
+sim_blocking_t sim_blocking[NUM_TCBS];
+
+static int pendsv_pending = 0;
+static int handler_depth = 0; // SysTick and PendSV handlers running, PendSV cannot preempt them
+static int svc_status = 0;
+static int systick_running = 0;
+static int stopped = 0;
+static uint32_t now = 0;
+static uint32_t end_time = 0;
+static uint32_t cycles_per_tick = 0;
+
+static ucontext_t contexts[NUM_TCBS];
+static char* stacks[NUM_TCBS];
+static int alive[NUM_TCBS]; // the context of the thread has been started and not killed
+static void* saved_msp[NUM_TCBS]; // what the kernel returned when the thread was last switched in
+
+// main's frames, the boot code sets them up on the board
+static interrupt_stack_frame main_psp_frame;
+static msp_stack_frame_t main_msp_frame;
+
+/**
+ *
+ * @brief First function of every simulated thread, runs the function and argument of the
+ * initial frame which tcb_init built, then kills the thread like thread_kill_working does.
+ *
+ **/
+
+static void thread_entry() {
+    uint32_t tid = currentRunningThreadID;
+    msp_stack_frame_t* msp = (msp_stack_frame_t*)saved_msp[tid];
+    void (*fn)(void*) = (void (*)(void*))msp->psp->pc;
+
+    // the argument was stored as a 32 bit register, simulated threads pass small integers
+    fn((void*)(uintptr_t)msp->psp->r0);
+
+    sys_thread_kill();
+    fprintf(stderr, "sim: killed thread %u still running\n", tid);
+    abort();
+}
+
+/**
+ *
+ * @brief Runs the PendSV handler and switches to the coroutine of the thread it picked, starting
+ * it first if it never ran or was killed since.
+ *
+ **/
+
+static void sim_pendsv() {
+    uint32_t prev = currentRunningThreadID;
+
+    handler_depth++;
+    pendsv_pending = 0;
+    void* msp = pendsv_c_handler(saved_msp[prev]);
+    handler_depth--;
+
+    uint32_t next = currentRunningThreadID;
+    saved_msp[next] = msp;
+
+    // threads killed by another thread never switched out as STOPPED, their TCB may be reused
+    for (uint32_t i = 1; i < IDLE_THREAD_ID; i++) {
+        if ((i != prev) && (TCB[i].state == STOPPED)) {
+            alive[i] = 0;
+        }
+    }
+
+    if (next == prev) {
+        return;
+    }
+
+    if ((prev != MAIN_THREAD_ID) && (TCB[prev].state == STOPPED)) {
+        alive[prev] = 0;
+    }
+
+    if (!alive[next]) {
+        if (stacks[next] == NULL) {
+            stacks[next] = malloc(SIM_STACK_SIZE);
+            if (stacks[next] == NULL) {
+                fprintf(stderr, "sim: out of memory\n");
+                exit(1);
+            }
+        }
+        getcontext(&contexts[next]);
+        contexts[next].uc_stack.ss_sp = stacks[next];
+        contexts[next].uc_stack.ss_size = SIM_STACK_SIZE;
+        contexts[next].uc_link = NULL;
+        makecontext(&contexts[next], thread_entry, 0);
+        alive[next] = 1;
+    }
+
+    swapcontext(&contexts[prev], &contexts[next]);
+}
+
+void pend_pendsv() {
+    if (stopped) {
+        return;
+    }
+    pendsv_pending = 1;
+    if (!sim_primask && (handler_depth == 0)) {
+        sim_pendsv();
+    }
+}
+
+void sim_interrupts_enabled() {
+    if (pendsv_pending && (handler_depth == 0) && !stopped) {
+        sim_pendsv();
+    }
+}
+
+void clear_pendsv() {
+    pendsv_pending = 0;
+}
+
+int get_svc_status() {
+    return svc_status;
+}
+
+void set_svc_status(int status) {
+    svc_status = status;
+}
+
+void init_align_prio() {}
+void enable_prefetch_i_cache() {}
+void enable_fpu() {}
+void set_enable_memfault() {}
+void enable_cycle_counter() {}
+
+/**
+ *
+ * @brief Charges blocking to every thread which is ready or blocked while a thread of lower
+ * static priority runs, the job's total is kept once the thread waits for its next period.
+ *
+ **/
+
+static void account_blocking() {
+    tcb_t* running = &TCB[currentRunningThreadID];
+    int user_running = (currentRunningThreadID != MAIN_THREAD_ID) && (currentRunningThreadID != IDLE_THREAD_ID);
+
+    for (uint32_t i = 1; i < IDLE_THREAD_ID; i++) {
+        sim_blocking_t* b = &sim_blocking[i];
+        state_t state = TCB[i].state;
+
+        if (user_running && ((state == RUNNABLE) || (state == BLOCKED)) &&
+            (TCB[i].static_priority < running->static_priority)) {
+            b->total++;
+            b->job++;
+        }
+        else if ((state == WAITING) || (state == STOPPED)) {
+            if (b->job > b->max) {
+                b->max = b->job;
+            }
+            b->job = 0;
+        }
+    }
+}
+
+/**
+ *
+ * @brief One tick of CPU for the running thread, ends with the SysTick and any PendSV it pended.
+ * Returns to main once the simulation time is over.
+ *
+ **/
+
+static void sim_tick() {
+    if (stopped || !systick_running) {
+        return;
+    }
+
+    if ((int32_t)(now - end_time) >= 0) {
+        stopped = 1;
+        swapcontext(&contexts[currentRunningThreadID], &contexts[MAIN_THREAD_ID]);
+        return;
+    }
+
+    account_blocking();
+
+    now++;
+    sim_cycles += cycles_per_tick;
+
+    handler_depth++;
+    systick_c_handler();
+    handler_depth--;
+
+    if (pendsv_pending && !sim_primask) {
+        sim_pendsv();
+    }
+}
+
+void sim_compute(uint32_t ticks) {
+    while ((ticks-- != 0) && !stopped) {
+        sim_tick();
+    }
+}
+
+uint32_t sim_now() {
+    return now;
+}
+
+/** @brief the idle thread burns ticks until something is released */
+void default_idle() {
+    while (1) {
+        sim_tick();
+    }
+}
+
+/** @brief return address of thread functions on the board, see thread_entry() */
+void thread_kill_working() {
+    sys_thread_kill();
+}
+
+int sim_init(uint32_t max_threads, uint32_t max_mutexes, uint32_t policy) {
+    main_msp_frame.psp = &main_psp_frame;
+    TCB[MAIN_THREAD_ID].msp = &main_msp_frame;
+    saved_msp[MAIN_THREAD_ID] = &main_msp_frame;
+    alive[MAIN_THREAD_ID] = 1;
+
+    return sys_thread_init(max_threads, 256, NULL, KERNEL_ONLY, max_mutexes, policy);
+}
+
+int sim_run(uint32_t frequency, uint32_t ticks, uint32_t mode) {
+    if ((frequency == 0) || (frequency > SIM_CPU_HZ) || (mode & SCHED_MODE_TICKLESS)) {
+        return -1;
+    }
+    cycles_per_tick = SIM_CPU_HZ / frequency;
+    end_time = now + ticks;
+
+    // back here once every thread exited or the time is over
+    int status = sys_scheduler_start(frequency, mode);
+    stopped = 1;
+
+    for (uint32_t i = 1; i < IDLE_THREAD_ID; i++) {
+        if (sim_blocking[i].job > sim_blocking[i].max) {
+            sim_blocking[i].max = sim_blocking[i].job;
+        }
+    }
+    return status;
+}
+
+// the simulated peripherals
+
+int mm_region_enable(uint32_t region_number, void* base_address, uint8_t size_log2, int execute, int user_write_access) {
+    return mm_region_enable_srd(region_number, base_address, size_log2, 0, execute, user_write_access);
+}
+
+int mm_region_enable_srd(uint32_t region_number, void* base_address, uint8_t size_log2, uint8_t srd, int execute, int user_write_access) {
+    (void)region_number;
+    (void)base_address;
+    (void)size_log2;
+    (void)srd;
+    (void)execute;
+    (void)user_write_access;
+    return 0;
+}
+
+void mm_region_disable(uint32_t region_number) {
+    (void)region_number;
+}
+
+uint32_t mm_log2ceil_size(uint32_t n) {
+    uint32_t ret = 0;
+    while(n > (1U << ret)) {
+        ret++;
+    }
+    return ret;
+}
+
+void systick_start(int frequency) {
+    (void)frequency;
+    systick_running = 1;
+}
+
+void systick_stop() {
+    systick_running = 0;
+}
+
+void oneshot_timer_start() {
+    fprintf(stderr, "sim: tickless mode is not simulated\n");
+    exit(1);
+}
+
+void oneshot_timer_stop() {}
+
+uint32_t oneshot_timer_now() {
+    return 0;
+}
+
+void oneshot_timer_set(uint32_t count) {
+    (void)count;
+}
+
+int i2c_leader_write(uint8_t *tx_buf, uint8_t tx_len, uint8_t follower_addr) {
+    (void)tx_buf;
+    (void)tx_len;
+    (void)follower_addr;
+    return -1;
+}
+
+int i2c_leader_read(uint8_t *rx_buf, uint8_t rx_len, uint8_t follower_addr) {
+    (void)rx_buf;
+    (void)rx_len;
+    (void)follower_addr;
+    return -1;
+}
+
+void i2c_leader_stop() {}
+
+int16_t adc_read_pin() {
+    return 0;
+}
+
+void glow_led(int on) {
+    (void)on;
+}
+
+void pwm_actuate_forward(void) {}
+void pwm_actuate_backward(void) {}
+void pwm_actuate_left(void) {}
+void pwm_actuate_right(void) {}
+void pwm_stop(void) {}
+
+uint32_t rtt_write(uint32_t buffer_index, const void* p_buffer, uint32_t num_bytes) {
+    if ((buffer_index == 0) && !sim_quiet) {
+        fwrite(p_buffer, 1, num_bytes, stdout);
+    }
+    return num_bytes;
+}
+
+uint32_t rtt_has_data(uint32_t buffer_index) {
+    (void)buffer_index;
+    return 0;
+}
+
+void sys_exit(int status) {
+    printf("sim: kernel exit with status %d at tick %u\n", status, now);
+    exit(status);
+}
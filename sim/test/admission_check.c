@@ -0,0 +1,567 @@
+/** @file   admission_check.c
+ *
+ *  @brief  checks the fixed point admission tests of the kernel against a
+ *          floating point reference on random task sets
+ *
+ *      admission_check [sets] [first seed]
+ *
+ *  Every task set is created thread by thread on a fresh kernel, once under
+ *  each policy, and every decision of sys_thread_create_attr must match the
+ *  reference. Under EDF that is the density sum in long double. Under RMS
+ *  it is the Liu and Layland bound in double where it applies and an exact
+ *  response time analysis otherwise, as the kernel did before it moved to
+ *  Q32 sums. A density within the rounding of the sums (under 2^-32 per
+ *  thread) over 1 may go either way, the kernel documents that it admits it.
+ *
+ *  Random sets mix constrained deadlines, a mutex, rate monotonic or random
+ *  priorities and kills between the creates. Some creates are preempted at
+ *  a random interrupt point, through sim_interrupt_hook, by another create
+ *  or a kill, so the admission_epoch retry is checked too: the create must
+ *  decide against the task set as it is once it commits. Harmonic sets land
+ *  exactly on U = 1 or one tick of the longest period either side, and
+ *  others land within 2e-6 of the Liu and Layland bound either side.
+**/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <arm.h>
+#include <syscall_mutex.h>
+#include <syscall_thread.h>
+#include <sim.h>
+
+/** @brief default number of task sets per policy */
+#define DEFAULT_SETS 10000
+
+/** @brief density slack of the kernel, every Q32 term is rounded up by less than 2^-32 */
+#define Q32_SLACK (1.0L / 4294967296.0L)
+
+/** @brief kinds of task sets */
+#define SET_RANDOM 0
+#define SET_HARMONIC 1
+#define SET_BOUND 2
+#define SET_KINDS 3
+
+/** @brief reference decisions, besides 0 and -1 as returned by sys_thread_create_attr */
+#define REF_EITHER 1
+
+typedef struct {
+  uint32_t prio;
+  uint32_t C;
+  uint32_t T;
+  uint32_t D;
+  uint32_t tid; // TCB index once admitted /
+} task_t;
+
+typedef struct {
+  uint32_t creates; // creates checked /
+  uint32_t admitted; // creates the kernel admitted /
+  uint32_t bound; // RMS creates the reference admitted by the Liu and Layland bound /
+  uint32_t rta; // RMS creates the reference decided by response time analysis /
+  uint32_t either; // creates within the rounding of the sums /
+  uint32_t preempted; // creates another create or a kill preempted /
+  uint32_t kills; // kills between or inside the creates /
+  uint32_t mismatches;
+} stats_t;
+
+static const char* kind_names[] = { "random", "harmonic", "bound" };
+
+static task_t live[MAX_THREADS]; // the task set the kernel should hold /
+static uint32_t num_live = 0;
+static uint32_t policy = SCHED_POLICY_RMS;
+static int has_mutex = 0;
+static int constrained = 0;
+static int rm = 0;
+static uint32_t set_seed = 0;
+static uint32_t hook_countdown = 0;
+static int ref_by_bound = 0; // the last RMS reference was the utilization bound /
+static stats_t stats;
+
+static void task_fn(void* vargp) {
+    (void)vargp;
+}
+
+/**
+ *
+ * @brief Random number in [lo, hi].
+ *
+ **/
+
+static uint32_t random_range(uint32_t lo, uint32_t hi) {
+    return lo + (uint32_t)(((uint64_t)rand() * (hi - lo + 1)) / ((uint64_t)RAND_MAX + 1));
+}
+
+/**
+ *
+ * @brief A random task, priorities are given by period under rm and at random otherwise.
+ *
+ **/
+
+static task_t random_task() {
+    task_t t;
+
+    t.T = random_range(10, 5000);
+    t.C = random_range(1, 1 + (t.T * random_range(1, 60)) / 100);
+    if (t.C > t.T) {
+        t.C = t.T;
+    }
+    t.D = constrained ? random_range(t.C, t.T) : t.T;
+    // periods up to 5000 give rate monotonic priorities in 0..25, below BACKGROUND_PRIORITY
+    t.prio = rm ? t.T / 200 : random_range(0, 7);
+    t.tid = 0;
+    return t;
+}
+
+/**
+ *
+ * @brief Reference EDF density test of the live set with t added.
+ *
+ **/
+
+static int ref_edf(const task_t* t) {
+    long double density = (long double)t->C / t->D;
+
+    for (uint32_t i = 0; i < num_live; i++) {
+        density += (long double)live[i].C / live[i].D;
+    }
+    // 1e-15 absorbs the rounding of the sum in long double, the kernel admits that much and more
+    if (density <= 1.0L + 1e-15L) {
+        return 0;
+    }
+    if (density <= 1.0L + (num_live + 1) * Q32_SLACK) {
+        return REF_EITHER;
+    }
+    return -1;
+}
+
+/**
+ *
+ * @brief Task i of the live set with t added as index num_live.
+ *
+ **/
+
+static const task_t* task_at(uint32_t i, const task_t* t) {
+    return (i == num_live) ? t : &live[i];
+}
+
+/**
+ *
+ * @brief Reference response time analysis of the live set with t added. A lower priority task
+ * blocks for its whole C when the mutex exists, its ceiling is the highest priority.
+ *
+ **/
+
+static int ref_rta(const task_t* t) {
+    uint32_t n = num_live + 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        const task_t* ti = task_at(i, t);
+        uint64_t blocking = 0;
+
+        for (uint32_t k = 0; has_mutex && (k < n); k++) {
+            const task_t* tk = task_at(k, t);
+            if ((tk->prio > ti->prio) && (tk->C > blocking)) {
+                blocking = tk->C;
+            }
+        }
+
+        uint64_t response = ti->C + blocking;
+        uint64_t previous = 0;
+
+        while ((response != previous) && (response <= ti->D)) {
+            previous = response;
+            response = ti->C + blocking;
+            for (uint32_t j = 0; j < n; j++) {
+                const task_t* tj = task_at(j, t);
+                if ((j != i) && (tj->prio <= ti->prio)) {
+                    response += ((previous + tj->T - 1) / tj->T) * tj->C;
+                }
+            }
+        }
+        if (response > ti->D) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ *
+ * @brief Reference RMS test of the live set with t added, the utilization bound in double where
+ * it holds (D = T, no blocking, distinct rate monotonic priorities), else the exact analysis.
+ *
+ **/
+
+static int ref_rms(const task_t* t) {
+    uint32_t n = num_live + 1;
+    double util = 0;
+    int bound_holds = !has_mutex;
+
+    for (uint32_t i = 0; i < n; i++) {
+        const task_t* ti = task_at(i, t);
+
+        util += (double)ti->C / ti->T;
+        if (ti->D != ti->T) {
+            bound_holds = 0;
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            const task_t* tj = task_at(j, t);
+            if ((i != j) && ((ti->prio == tj->prio) || ((ti->prio < tj->prio) && (ti->T > tj->T)))) {
+                bound_holds = 0;
+            }
+        }
+    }
+
+    ref_by_bound = bound_holds && (util <= n * (pow(2.0, 1.0 / n) - 1.0));
+    if (ref_by_bound) {
+        if (ref_rta(t) != 0) {
+            fprintf(stderr, "seed %u: the bound admits a set the analysis rejects\n", set_seed);
+            stats.mismatches++;
+        }
+        return 0;
+    }
+    return ref_rta(t);
+}
+
+static int reference(const task_t* t) {
+    return (policy == SCHED_POLICY_EDF) ? ref_edf(t) : ref_rms(t);
+}
+
+/**
+ *
+ * @brief Counts a checked create by how the last reference decided it.
+ *
+ **/
+
+static void count_create(int expect, int got) {
+    stats.creates++;
+    if (got == 0) {
+        stats.admitted++;
+    }
+    if (expect == REF_EITHER) {
+        stats.either++;
+    }
+    else if (policy == SCHED_POLICY_RMS) {
+        if (ref_by_bound) {
+            stats.bound++;
+        }
+        else {
+            stats.rta++;
+        }
+    }
+}
+
+static int create(task_t* t) {
+    thread_attr_t attr = { t->C, t->T, t->D, THREAD_TYPE_PERIODIC, 0, 0, 0, 0, 0 };
+    int result = sys_thread_create_attr(task_fn, t->prio, &attr, NULL);
+
+    t->tid = attr.tid;
+    return result;
+}
+
+static void report_mismatch(const char* what, const task_t* t, int got, int expect) {
+    fprintf(stderr, "seed %u %s: %s C %u T %u D %u prio %u with %u live, kernel %d reference %d\n",
+            set_seed, (policy == SCHED_POLICY_EDF) ? "EDF" : "RMS", what, t->C, t->T, t->D, t->prio,
+            num_live, got, expect);
+    stats.mismatches++;
+}
+
+static void live_add(const task_t* t) {
+    live[num_live++] = *t;
+}
+
+/**
+ *
+ * @brief Kills live task i, atomically as an interrupt handler would. The scheduler does not
+ * run, so the PendSV the kill pends is dropped.
+ *
+ **/
+
+static void kill_task(uint32_t i) {
+    int interrupt_status = sim_primask;
+
+    sim_primask = 1;
+    if (sys_thread_kill_tid(live[i].tid) != 0) {
+        fprintf(stderr, "seed %u: kill of thread %u failed\n", set_seed, live[i].tid);
+        stats.mismatches++;
+    }
+    clear_pendsv();
+    sim_primask = interrupt_status;
+
+    live[i] = live[--num_live];
+    stats.kills++;
+}
+
+/**
+ *
+ * @brief Interrupt hook, once the countdown runs out a kill or a create runs in the middle of
+ * the create in progress.
+ *
+ **/
+
+static void preempt() {
+    if (--hook_countdown > 0) {
+        return;
+    }
+    sim_interrupt_hook = NULL;
+    stats.preempted++;
+
+    // the create in progress holds a TCB of its own
+    if ((num_live > 0) && ((rand() % 2) || (num_live + 2 > MAX_THREADS))) {
+        kill_task(random_range(0, num_live - 1));
+        return;
+    }
+
+    task_t t = random_task();
+    int expect = reference(&t);
+    int got = create(&t);
+
+    count_create(expect, got);
+    if ((expect != REF_EITHER) && (got != expect)) {
+        report_mismatch("nested create", &t, got, expect);
+    }
+    if (got == 0) {
+        live_add(&t);
+    }
+}
+
+/**
+ *
+ * @brief Creates t and checks the decision. A preempted create may see the set before or after
+ * the preemption when it rejects, but must have decided against the set after it when it
+ * admits, its commit comes after every interrupt point.
+ *
+ **/
+
+static void check_create(task_t* t, int preempt_it) {
+    int expect_before = reference(t);
+
+    if (preempt_it) {
+        hook_countdown = random_range(1, 4);
+        sim_interrupt_hook = preempt;
+    }
+    uint32_t preempted = stats.preempted;
+    int got = create(t);
+    sim_interrupt_hook = NULL;
+
+    int expect = (stats.preempted != preempted) ? reference(t) : expect_before;
+
+    count_create(expect, got);
+    if (got == 0) {
+        if (expect == -1) {
+            report_mismatch("create", t, got, expect);
+        }
+        live_add(t);
+    }
+    else if ((expect == 0) && (expect_before == 0)) {
+        report_mismatch("create", t, got, expect);
+    }
+}
+
+/**
+ *
+ * @brief Harmonic periods with rate monotonic priorities whose utilization is exactly 1, or the
+ * longest task one tick over or under it.
+ *
+ **/
+
+static uint32_t harmonic_set(task_t* set) {
+    uint32_t n = random_range(1, 12);
+    uint32_t T = random_range(2, 20);
+
+    for (uint32_t i = 0; i < n; i++) {
+        set[i].T = T;
+        set[i].D = T;
+        set[i].prio = i;
+        T *= random_range(1, 3);
+    }
+
+    uint32_t hyper = set[n - 1].T;
+    uint32_t used = 0;
+
+    for (uint32_t i = 0; i + 1 < n; i++) {
+        set[i].C = random_range(1, 1 + set[i].T / (2 * n));
+        used += set[i].C * (hyper / set[i].T);
+    }
+    if (used >= hyper) {
+        return 0;
+    }
+    set[n - 1].C = hyper - used;
+    if (random_range(0, 2) == 0) {
+        set[n - 1].C++;
+    }
+    else if ((random_range(0, 1) == 0) && (set[n - 1].C > 1)) {
+        set[n - 1].C--;
+    }
+    return (set[n - 1].C <= set[n - 1].T) ? n : 0;
+}
+
+/**
+ *
+ * @brief Rate monotonic tasks whose utilization is within 2e-6 of the Liu and Layland bound,
+ * the longest task has a period near 10^6 and fills the set up to it.
+ *
+ **/
+
+static uint32_t bound_set(task_t* set) {
+    uint32_t n = random_range(2, 12);
+    double bound = n * (pow(2.0, 1.0 / n) - 1.0);
+    double util = 0;
+
+    for (uint32_t i = 0; i + 1 < n; i++) {
+        set[i].T = random_range(100, 5000);
+        set[i].C = 1 + (uint32_t)(set[i].T * 0.8 * bound / n);
+        set[i].D = set[i].T;
+        util += (double)set[i].C / set[i].T;
+    }
+    set[n - 1].T = random_range(1000000, 1001000);
+    set[n - 1].D = set[n - 1].T;
+    set[n - 1].C = (uint32_t)((bound - util) * set[n - 1].T) - 1 + random_range(0, 3);
+
+    // rate monotonic priorities, ties broken by index
+    for (uint32_t i = 0; i < n; i++) {
+        set[i].prio = 0;
+        for (uint32_t j = 0; j < n; j++) {
+            if ((set[j].T < set[i].T) || ((set[j].T == set[i].T) && (j < i))) {
+                set[i].prio++;
+            }
+        }
+    }
+    return n;
+}
+
+/**
+ *
+ * @brief Runs one task set on a fresh kernel, in a child process.
+ *
+ **/
+
+static void run_set(uint32_t kind) {
+    task_t set[MAX_THREADS];
+    uint32_t n = 0;
+
+    srand(set_seed * SET_KINDS + kind);
+    sim_quiet = 1;
+    if (sim_init(MAX_THREADS, 1, policy) != 0) {
+        fprintf(stderr, "seed %u: sim_init failed\n", set_seed);
+        stats.mismatches++;
+        return;
+    }
+
+    if (kind == SET_HARMONIC) {
+        n = harmonic_set(set);
+    }
+    else if (kind == SET_BOUND) {
+        n = bound_set(set);
+    }
+    else {
+        has_mutex = (rand() % 4 == 0);
+        constrained = (rand() % 3 == 0);
+        rm = rand() % 2;
+        if (has_mutex) {
+            sys_mutex_init(0);
+        }
+        n = random_range(1, 16);
+    }
+
+    // the fixed sets are created in random order, so the last create is not always the longest
+    for (uint32_t i = n; i > 1; i--) {
+        uint32_t j = random_range(0, i - 1);
+        task_t t = set[i - 1];
+        set[i - 1] = set[j];
+        set[j] = t;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (kind != SET_RANDOM) {
+            check_create(&set[i], 0);
+        }
+        else if ((num_live > 0) && (rand() % 6 == 0)) {
+            kill_task(random_range(0, num_live - 1));
+        }
+        else if (num_live + 2 <= MAX_THREADS) {
+            task_t t = random_task();
+            check_create(&t, rand() % 3 == 0);
+        }
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s [sets] [first seed]\n", name);
+}
+
+int main(int argc, char** argv) {
+    uint32_t sets = DEFAULT_SETS;
+    uint32_t first = 0;
+    stats_t total[2][SET_KINDS] = { 0 };
+    uint32_t mismatches = 0;
+
+    if ((argc > 3) || ((argc > 1) && (sscanf(argv[1], "%u", &sets) != 1)) ||
+        ((argc > 2) && (sscanf(argv[2], "%u", &first) != 1))) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (uint32_t s = first; s < first + sets; s++) {
+        for (uint32_t p = 0; p < 2; p++) {
+            for (uint32_t kind = 0; kind < SET_KINDS; kind++) {
+                int pipe_fd[2];
+
+                if (pipe(pipe_fd) != 0) {
+                    perror("pipe");
+                    return 2;
+                }
+
+                pid_t pid = fork();
+                if (pid < 0) {
+                    perror("fork");
+                    return 2;
+                }
+                if (pid == 0) {
+                    // the kernel cannot be reset, every set gets a fresh copy of it
+                    policy = p ? SCHED_POLICY_EDF : SCHED_POLICY_RMS;
+                    set_seed = s;
+                    run_set(kind);
+                    _exit((write(pipe_fd[1], &stats, sizeof(stats)) == sizeof(stats)) ? 0 : 1);
+                }
+
+                stats_t child = { 0 };
+                int status = 0;
+                ssize_t got = read(pipe_fd[0], &child, sizeof(child));
+                close(pipe_fd[0]);
+                close(pipe_fd[1]);
+                waitpid(pid, &status, 0);
+                if ((got != sizeof(child)) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+                    fprintf(stderr, "seed %u: %s set crashed\n", s, kind_names[kind]);
+                    child.mismatches++;
+                }
+
+                stats_t* t = &total[p][kind];
+                t->creates += child.creates;
+                t->admitted += child.admitted;
+                t->bound += child.bound;
+                t->rta += child.rta;
+                t->either += child.either;
+                t->preempted += child.preempted;
+                t->kills += child.kills;
+                t->mismatches += child.mismatches;
+                mismatches += child.mismatches;
+            }
+        }
+    }
+
+    printf("%u task sets of each kind per policy\n", sets);
+    printf("policy kind       creates admitted  bound    rta either preempted  kills mismatches\n");
+    for (uint32_t p = 0; p < 2; p++) {
+        for (uint32_t kind = 0; kind < SET_KINDS; kind++) {
+            stats_t* t = &total[p][kind];
+            printf("%-6s %-9s %8u %8u %6u %6u %6u %9u %6u %10u\n", p ? "EDF" : "RMS", kind_names[kind],
+                   t->creates, t->admitted, t->bound, t->rta, t->either, t->preempted, t->kills,
+                   t->mismatches);
+        }
+    }
+    return (mismatches != 0) ? 1 : 0;
+}
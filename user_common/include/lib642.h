@@ -22,6 +22,18 @@
 
 typedef enum { PER_THREAD = 1, KERNEL_ONLY = 0 } mpu_mode;
 
+/** @brief scheduler_start_mode mode, fixed rate tick interrupt */
+#define SCHED_MODE_PERIODIC 0
+/** @brief scheduler_start_mode flag, only interrupt for releases and budget expiry */
+#define SCHED_MODE_TICKLESS (1 << 0)
+/** @brief scheduler_start_mode flag, run the threads from the schedule table */
+#define SCHED_MODE_TABLE (1 << 1)
+
+/** @brief thread_init_policy policy, fixed priority rate monotonic scheduling */
+#define SCHED_POLICY_RMS 0
+/** @brief thread_init_policy policy, earliest deadline first scheduling */
+#define SCHED_POLICY_EDF 1
+
 /**
  * @brief      Initialize the thread library
  *
@@ -29,8 +41,12 @@ typedef enum { PER_THREAD = 1, KERNEL_ONLY = 0 } mpu_mode;
  *             create any threads or start the scheduler.
  *
  * @param      max_threads        max number of threads created
- * @param      stack_size         Declares the size in words of all the stacks
- *                                for subsequent calls to thread create.
+ * @param      stack_size         Declares the size in words of the stacks
+ *                                of the idle thread and of threads created
+ *                                without a stack_size attribute. Stacks are
+ *                                allocated per thread out of 32KB, a stack of
+ *                                256 bytes or more is rounded up to an eighth
+ *                                of the next power of two.
  * @param      idle_func          Pointer to a thread function to run when no
  *                                other threads are runnable, if arg is NULL,
  *                                then kernel will supply default idle thread.
@@ -47,18 +63,43 @@ int thread_init(uint32_t max_threads,
                 mpu_mode memory_protection,
                 uint32_t max_mutexes);
 
+/**
+ * @brief      Same as thread_init, with a choice of scheduling policy.
+ *
+ *             thread_init always selects SCHED_POLICY_RMS. With
+ *             SCHED_POLICY_EDF the thread with the earliest deadline (the end
+ *             of its current period) runs, and thread_create admits threads
+ *             as long as the total utilization stays at or below 1. Mutexes
+ *             follow the stack resource policy, the thread priority is used as
+ *             the preemption level so it should still be assigned in order of
+ *             period, and the mutex ceiling is the highest priority of a
+ *             thread which uses it, as for RMS.
+ *
+ * @param      policy             SCHED_POLICY_RMS or SCHED_POLICY_EDF
+ *
+ * @return     0 on success or -1 on failure
+ */
+int thread_init_policy(uint32_t max_threads,
+                       uint32_t stack_size,
+                       void (*idle_func)(void),
+                       mpu_mode memory_protection,
+                       uint32_t max_mutexes,
+                       uint32_t policy);
+
 /**
  * @brief      Create a new thread running the given function
  *
  * @param      fn     Pointer to the function to run in the new thread.
  * @param      prio   Priority of this thread. Lower number are higher
- *                    priority.
+ *                    priority. The lowest level (31 by default) is kept
+ *                    for jobs which run on after an overrun and is
+ *                    refused.
  * @param      C      Real time execution time (ms).
  * @param      T      Real time task period (ms).
  * @param      vargp  Pointer to an argument.
  *
- * @return     0 on success or -1 on failure. Runs ub test for new task set
- *             will fail if over ub test.
+ * @return     0 on success or -1 on failure. Runs a response time test for
+ *             the new task set, will fail if any thread can miss its period.
  */
 int thread_create(void (*fn)(void* vargp),
                   uint32_t prio,
@@ -66,6 +107,113 @@ int thread_create(void (*fn)(void* vargp),
                   uint32_t T,
                   void* vargp);
 
+/**
+ * @brief      Timing attributes for thread_create_attr.
+ */
+typedef struct {
+  uint32_t C; /**< Real time execution time (ms). */
+  uint32_t T; /**< Real time task period (ms). */
+  uint32_t D; /**< Relative deadline (ms), C <= D <= T, 0 means D = T. */
+  uint32_t type; /**< THREAD_TYPE_PERIODIC or THREAD_TYPE_SERVER. */
+  uint32_t events; /**< SERVER_EVENT_* sources a server listens to. */
+  uint32_t stack_size; /**< Size in words of the thread stacks, 0 means the
+                            stack_size given to thread_init. */
+  uint32_t overrun; /**< OVERRUN_* policy of a periodic thread, 0 means
+                         OVERRUN_SUSPEND. */
+  uint32_t phase; /**< Release offset (ms) of a periodic thread, below T.
+                       Jobs are released phase after every multiple of T,
+                       counted from the scheduler start. The schedule
+                       table of SCHED_MODE_TABLE overrides it. */
+  uint32_t tid; /**< Set to the ID of the new thread on success, for
+                     thread_join and thread_kill_tid. */
+} thread_attr_t;
+
+/** @brief     Thread type, released at the start of every period. */
+#define THREAD_TYPE_PERIODIC 0
+/**
+ * @brief      Thread type, sporadic server.
+ *
+ *             The server runs when an event arrives, out of a budget of C
+ *             which the kernel replenishes: whatever the server consumed is
+ *             given back T after it started running. It is admitted and
+ *             analysed like a periodic thread with the same C and T. Not
+ *             available with SCHED_POLICY_EDF.
+ */
+#define THREAD_TYPE_SERVER 1
+
+/**
+ * @brief      Overrun policy, a job which used up C waits for its next
+ *             period. The default.
+ *
+ *             Budgets are counted in CPU cycles, C ticks worth of them, and
+ *             enforced at the next tick.
+ */
+#define OVERRUN_SUSPEND 0
+/**
+ * @brief      Overrun policy, the job runs on at the lowest priority level,
+ *             which no thread can be created at, until it calls
+ *             wait_until_next_period() or the next release, which starts a
+ *             new job with a fresh budget.
+ */
+#define OVERRUN_BACKGROUND 1
+/**
+ * @brief      Overrun policy, as OVERRUN_BACKGROUND and thread_overrun()
+ *             reports the overrun so that the thread can cut the job short.
+ */
+#define OVERRUN_NOTIFY 2
+/**
+ * @brief      Overrun policy, the thread is killed. Mutexes it holds are
+ *             unlocked and handed over to their waiters.
+ */
+#define OVERRUN_KILL 3
+
+/**
+ * @brief      Exit code of a thread killed by thread_kill_tid or
+ *             OVERRUN_KILL. A thread which returns from its function exits
+ *             with 0.
+ */
+#define THREAD_EXIT_KILLED (-1)
+
+/** @brief     Server event, console input is waiting. */
+#define SERVER_EVENT_CONSOLE (1 << 0)
+/** @brief     Server event, server_post() was called for the server. */
+#define SERVER_EVENT_POST (1 << 1)
+
+/**
+ * @brief      Same as thread_create, with the timing given as attributes so
+ *             that the deadline can be shorter than the period.
+ *
+ *             Under SCHED_POLICY_RMS the new task set is admitted by exact
+ *             response time analysis against each deadline, counting one
+ *             lower priority thread's C as blocking whenever a mutex ceiling
+ *             reaches a thread's priority.
+ *
+ *             The first job of a thread is released at the first multiple
+ *             of its period, plus the phase, which is not earlier than the
+ *             creation, so with phase 0 a thread created before the
+ *             scheduler starts runs at once. Threads may also be created
+ *             once the scheduler runs, they are admitted against the
+ *             threads alive at that time and wait for their first release
+ *             point, no two jobs are released less than a period apart.
+ *
+ *             Giving threads of harmonic periods different phases spreads
+ *             their releases over the ticks instead of releasing them all at
+ *             once. The admission test does not count on the phases, it
+ *             still assumes the worst case of simultaneous releases.
+ *
+ * @param      fn     Pointer to the function to run in the new thread.
+ * @param      prio   Priority of this thread, as for thread_create.
+ * @param      attr   Timing attributes, read once during the call, tid is
+ *                    written on success.
+ * @param      vargp  Pointer to an argument.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int thread_create_attr(void (*fn)(void* vargp),
+                       uint32_t prio,
+                       thread_attr_t* attr,
+                       void* vargp);
+
 /**
  * @brief      Allow the kernel to start running the added task set.
  *
@@ -80,6 +228,66 @@ int thread_create(void (*fn)(void* vargp),
  */
 int scheduler_start(uint32_t frequency);
 
+/**
+ * @brief      Same as scheduler_start, with a choice of scheduler mode.
+ *
+ *             In SCHED_MODE_TICKLESS the kernel does not interrupt on every
+ *             tick, only on the next release or when the running thread runs
+ *             out of budget. Time accounting stays in whole ticks. Threads
+ *             which poll get_time() or thread_time() with wfi (spin_wait,
+ *             spin_until) should use SCHED_MODE_PERIODIC.
+ *
+ * @param[in]  freq  The frequency
+ * @param[in]  mode  SCHED_MODE_PERIODIC, SCHED_MODE_TICKLESS or
+ *                   SCHED_MODE_TABLE
+ *
+ * @return     0 on success or -1 on failure
+ */
+int scheduler_start_mode(uint32_t frequency, uint32_t mode);
+
+/** @brief     Most minor frames in a schedule table. */
+#define SCHED_TABLE_MAX_FRAMES 64
+/** @brief     Most threads released in one minor frame. */
+#define SCHED_TABLE_FRAME_SLOTS 4
+
+/**
+ * @brief      Static time triggered schedule for SCHED_MODE_TABLE.
+ *
+ *             The major frame is num_frames minor frames of minor_ticks
+ *             each and repeats forever. At the start of a minor frame the
+ *             threads in its slots are released, then run in slot order,
+ *             each until it calls wait_until_next_period() or runs out of
+ *             budget. Threads not in the current frame do not run, a job
+ *             still unfinished when its frame ends counts as an overrun.
+ *             Threads are numbered from 1 in creation order, as getpid()
+ *             returns. util/sched_table_gen.py builds a table for a task set.
+ */
+typedef struct {
+  uint32_t minor_ticks; /**< Length of a minor frame in ticks. */
+  uint32_t num_frames;  /**< Minor frames in the major frame. */
+  uint8_t slots[SCHED_TABLE_MAX_FRAMES][SCHED_TABLE_FRAME_SLOTS]; /**< Threads
+                             released in every minor frame, in run order, a 0
+                             ends the frame's slots. */
+} sched_table_t;
+
+/**
+ * @brief      Load the schedule table run by SCHED_MODE_TABLE.
+ *
+ *             Call before scheduler_start_mode. Once a table is loaded
+ *             thread_create and thread_create_attr skip the admission test,
+ *             the table is expected to be checked when it is built, and no
+ *             threads can be created once the table runs. The scheduler
+ *             then only starts in SCHED_MODE_TABLE, and once a thread was
+ *             created the table can no longer be unloaded. A thread which
+ *             blocks keeps its slot and runs again once woken, within the
+ *             same minor frame.
+ *
+ * @param[in]  table  The table, copied by the kernel. NULL unloads it.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int sched_table_set(sched_table_t* table);
+
 /**
  * @brief      Get the current time.
  *
@@ -107,6 +315,215 @@ uint32_t thread_time();
  */
 void wait_until_next_period();
 
+/**
+ * @brief      Sleep until an absolute time, off the run queue.
+ *
+ *             Unlike spin_until the thread uses no CPU while it sleeps. A
+ *             new period starting during the sleep does not wake it.
+ *
+ * @param      time  Absolute time in ticks, as returned by get_time().
+ *
+ * @return     0 on success, -1 if called from main or the idle thread.
+ */
+int sleep_until(uint32_t time);
+
+/**
+ * @brief      Sleep for a number of ticks, same as
+ *             sleep_until(get_time() + ticks).
+ *
+ * @param      ticks  Ticks to sleep for.
+ *
+ * @return     0 on success, -1 if called from main or the idle thread.
+ */
+int sleep_ticks(uint32_t ticks);
+
+/**
+ * @brief      Sleep for at least ms milliseconds, rounded up to whole
+ *             ticks. Returns at once before the scheduler is started.
+ *
+ * @param      ms  Milliseconds to sleep for.
+ */
+void delay_ms(uint32_t ms);
+
+/**
+ * @brief      Read the core cycle counter, which starts at 0 on reset and
+ *             wraps around every 2^32 cycles.
+ *
+ *             The counter is read inside the SVC, so the difference of two
+ *             back to back calls is the cost of one syscall round trip.
+ *
+ * @return     The cycle count.
+ */
+uint32_t get_cycles();
+
+/** @brief     Kernel probe ids, the index into probe_dump()'s stats. */
+//@{
+#define PROBE_SVC     0 /**< svc_c_handler, not counting syscalls which blocked. */
+#define PROBE_PENDSV  1 /**< pendsv_c_handler */
+#define PROBE_SYSTICK 2 /**< systick_c_handler */
+#define PROBE_SAADC   3 /**< SAADC_IRQHandler */
+#define PROBE_GPIOTE  4 /**< GPIOTE_IRQHandler */
+#define NUM_PROBES    5
+//@}
+
+/** @brief     probe_dump flag, print every probe over RTT. */
+#define PROBE_DUMP_PRINT (1 << 0)
+/** @brief     probe_dump flag, zero the probes after the dump. */
+#define PROBE_DUMP_RESET (1 << 1)
+
+/**
+ * @brief      Cycles spent in a kernel exception handler, including any
+ *             exception which preempted it.
+ */
+typedef struct {
+  uint64_t total;   /**< Cycles of all counted calls. */
+  uint32_t count;   /**< Counted calls. */
+  uint32_t min;     /**< Fewest cycles of a call, UINT32_MAX before the first. */
+  uint32_t max;     /**< Most cycles of a call. */
+  uint32_t blocked; /**< Syscalls which switched threads, not counted. */
+} probe_stats_t;
+
+/**
+ * @brief      Copy, print and/or reset the kernel probes. Only a kernel
+ *             built with PROFILE=1 has probes.
+ *
+ * @param[out] stats  Where to copy the probes, indexed by PROBE_*, or NULL.
+ * @param[in]  n      Number of probe_stats_t which fit in stats.
+ * @param[in]  flags  PROBE_DUMP_PRINT and/or PROBE_DUMP_RESET.
+ *
+ * @return     NUM_PROBES, -1 if the kernel has no probes.
+ */
+int probe_dump(probe_stats_t* stats, uint32_t n, uint32_t flags);
+
+/** @brief     Number of response time histogram buckets. */
+#define STATS_HIST_BUCKETS 16
+
+/**
+ * @brief      Timing statistics of a thread, all times in ticks.
+ *
+ *             A job is released at the start of every period and completes
+ *             when the thread calls wait_until_next_period() or, under
+ *             OVERRUN_SUSPEND, runs out of budget (an overrun). Histogram bucket 0 counts response times
+ *             of 0, bucket k > 0 counts [2^(k-1), 2^k), the last bucket also
+ *             counts everything longer.
+ */
+typedef struct {
+  uint32_t jobs;            /**< Completed jobs. */
+  uint32_t response_min;    /**< Shortest release to completion time. */
+  uint32_t response_max;    /**< Longest release to completion time. */
+  uint32_t response_total;  /**< Sum of the response times. */
+  uint32_t response_avg;    /**< Average response time. */
+  uint32_t latency_min;     /**< Shortest release to first dispatch time. */
+  uint32_t latency_max;     /**< Longest release to first dispatch time. */
+  uint32_t jitter;          /**< Release jitter, latency_max - latency_min. */
+  uint32_t overruns;        /**< Jobs which ran out of budget. */
+  uint32_t deadline_misses; /**< Jobs which completed late or not at all. */
+  uint32_t hist[STATS_HIST_BUCKETS]; /**< Response time histogram. */
+} thread_stats_t;
+
+/**
+ * @brief      Get the timing statistics of a thread.
+ *
+ * @param[in]  tid    Thread ID, getpid() in the thread itself.
+ * @param[out] stats  Where to copy the statistics.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int thread_stats(uint32_t tid, thread_stats_t* stats);
+
+/**
+ * @brief      Stack use of a thread in bytes.
+ *
+ *             The kernel paints every stack when the thread is created and
+ *             checks a few words of the stacks whenever the CPU goes idle,
+ *             the used sizes are the deepest any word was written. They may
+ *             lag behind a little, and miss words written with the paint
+ *             value 0xA5A5A5A5.
+ */
+typedef struct {
+  uint32_t user_size;   /**< Size of the user stack. */
+  uint32_t user_used;   /**< Most of the user stack used so far. */
+  uint32_t kernel_size; /**< Size of the kernel stack. */
+  uint32_t kernel_used; /**< Most of the kernel stack used so far. */
+} stack_usage_t;
+
+/**
+ * @brief      Get the stack high water marks of a thread, for example to size
+ *             thread_attr_t stack_size.
+ *
+ * @param[in]  tid    Thread ID, getpid() in the thread itself, or
+ *                    the kernel's MAX_THREADS + 1 (15 by default) for the
+ *                    idle thread.
+ * @param[out] usage  Where to copy the stack use.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int thread_stack_usage(uint32_t tid, stack_usage_t* usage);
+
+/**
+ * @brief      OVERRUN_NOTIFY only, check whether the calling thread's jobs
+ *             overran their budget.
+ *
+ *             Every overrun is also counted in thread_stats() overruns,
+ *             under every policy.
+ *
+ * @return     The overruns since the last call, 0 if none.
+ */
+uint32_t thread_overrun();
+
+/**
+ * @brief      Sporadic server only, wait until an event arrives.
+ *
+ * @return     The SERVER_EVENT_* bits which arrived since the last call, -1
+ *             if the calling thread is not a server.
+ */
+int server_wait();
+
+/**
+ * @brief      Signal a sporadic server with SERVER_EVENT_POST.
+ *
+ * @param[in]  tid  Thread ID of the server, getpid() in the server itself.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int server_post(uint32_t tid);
+
+/**
+ * @brief      End the calling thread, its joiners get the exit code. Its TCB
+ *             and stacks are free for a new thread_create at once.
+ *
+ * @param[in]  exit_code  Returned to thread_join.
+ */
+void thread_exit(int exit_code);
+
+/**
+ * @brief      Kill a thread, for example to switch feature sets while the
+ *             scheduler runs. Its joiners get THREAD_EXIT_KILLED.
+ *
+ *             The thread stops wherever it is, also while asleep or waiting
+ *             on a semaphore, event, message queue or mutex. As with
+ *             OVERRUN_KILL, mutexes it holds are unlocked and handed over
+ *             to their waiters.
+ *
+ * @param[in]  tid  Thread ID, from thread_attr_t tid or getpid().
+ *
+ * @return     0 on success or -1 if there is no such thread.
+ */
+int thread_kill_tid(uint32_t tid);
+
+/**
+ * @brief      Wait until a thread exits.
+ *
+ *             A thread which already exited is joined at once, as long as
+ *             its TCB was not taken by a later thread_create.
+ *
+ * @param[in]  tid        Thread ID, from thread_attr_t tid or getpid().
+ * @param[out] exit_code  Where to store its exit code, may be NULL.
+ *
+ * @return     0 on success or -1 from main or for the calling thread itself.
+ */
+int thread_join(uint32_t tid, int* exit_code);
+
 /**
  * @brief      Type definition for mutex, opaque to user
  */
@@ -144,6 +561,205 @@ void mutex_lock(mutex_t* mutex);
  */
 void mutex_unlock(mutex_t* mutex );
 
+/** @brief     Timeout of a blocking wait which never expires. */
+#define WAIT_FOREVER 0xFFFFFFFF
+
+/**
+ * @brief      Type definition for a counting semaphore, opaque to user
+ */
+typedef struct {
+  char unused;
+} sem_t;
+
+/**
+ * @brief      Create a counting semaphore.
+ *
+ * @param      count  Initial count.
+ * @param      max    Largest count, at least 1 and at least count.
+ *
+ * @return     A semaphore handle, NULL if the kernel pool is exhausted.
+ */
+sem_t* sem_init(uint32_t count, uint32_t max);
+
+/**
+ * @brief      Take a unit of a semaphore, sleeping while none is available.
+ *
+ *             Waiters are woken in priority order, a post hands its unit
+ *             straight to the highest priority waiter. From main or the
+ *             idle function it only polls, whatever the timeout.
+ *
+ * @param      sem      The semaphore to act on.
+ * @param      timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no
+ *                      limit.
+ *
+ * @return     0 once a unit was taken, -1 on timeout.
+ */
+int sem_wait(sem_t* sem, uint32_t timeout);
+
+/**
+ * @brief      Give a unit back to a semaphore, never blocks.
+ *
+ * @param      sem  The semaphore to act on.
+ *
+ * @return     0 on success, -1 if the count is already at its max.
+ */
+int sem_post(sem_t* sem);
+
+/** @brief     event_wait option, wake when any of the flags is set. */
+#define EVENT_WAIT_ANY 0
+/** @brief     event_wait option, wake when all of the flags are set. */
+#define EVENT_WAIT_ALL (1 << 0)
+/** @brief     event_wait option, clear the flags which woke the waiter. */
+#define EVENT_WAIT_CLEAR (1 << 1)
+
+/**
+ * @brief      Type definition for a group of 32 event flags, opaque to user
+ */
+typedef struct {
+  char unused;
+} event_t;
+
+/**
+ * @brief      Create an event flag group with every flag clear.
+ *
+ * @return     An event group handle, NULL if the kernel pool is exhausted.
+ */
+event_t* event_init();
+
+/**
+ * @brief      Wait for flags of an event group, sleeping until they are set.
+ *             From main or the idle function it only polls, whatever the
+ *             timeout.
+ *
+ * @param      event    The group to act on.
+ * @param      mask     Flags to wait for, not 0.
+ * @param      options  EVENT_WAIT_ANY or EVENT_WAIT_ALL, or'ed with
+ *                      EVENT_WAIT_CLEAR to consume the flags.
+ * @param      timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no
+ *                      limit.
+ *
+ * @return     The flags of mask which ended the wait, 0 on timeout.
+ */
+uint32_t event_wait(event_t* event, uint32_t mask, uint32_t options, uint32_t timeout);
+
+/**
+ * @brief      Set flags of an event group, waking the threads waiting for
+ *             them. Never blocks.
+ *
+ * @param      event  The group to act on.
+ * @param      flags  Flags to set.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int event_set(event_t* event, uint32_t flags);
+
+/**
+ * @brief      Clear flags of an event group.
+ *
+ * @param      event  The group to act on.
+ * @param      flags  Flags to clear.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int event_clear(event_t* event, uint32_t flags);
+
+/** @brief     Most slots in a message queue. */
+#define MSGQ_MAX_SLOTS 32
+
+/**
+ * @brief      Type definition for a message queue, opaque to user
+ */
+typedef struct {
+  char unused;
+} msgq_t;
+
+/**
+ * @brief      Create a message queue of fixed size slots.
+ *
+ *             The slots live in buf, which the queue uses in place, so it
+ *             must be a global every thread using the queue can access.
+ *             Messages are received in the order their slots were reserved.
+ *             From main or the idle function the calls which sleep only
+ *             poll, whatever the timeout.
+ *
+ * @param      buf        Slot memory, slots * slot_size bytes.
+ * @param      slot_size  Size of a message in bytes.
+ * @param      slots      Number of slots, at most MSGQ_MAX_SLOTS.
+ *
+ * @return     A queue handle, NULL on failure.
+ */
+msgq_t* msgq_init(void* buf, uint32_t slot_size, uint32_t slots);
+
+/**
+ * @brief      Copy a message of slot_size bytes into the queue, sleeping
+ *             while it is full.
+ *
+ * @param      q        The queue to act on.
+ * @param      msg      The message.
+ * @param      timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no
+ *                      limit.
+ *
+ * @return     0 on success, -1 on timeout.
+ */
+int msgq_send(msgq_t* q, const void* msg, uint32_t timeout);
+
+/**
+ * @brief      Copy the oldest message out of the queue, sleeping while it is
+ *             empty.
+ *
+ * @param      q        The queue to act on.
+ * @param      msg      Buffer of at least slot_size bytes.
+ * @param      timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no
+ *                      limit.
+ *
+ * @return     0 on success, -1 on timeout.
+ */
+int msgq_recv(msgq_t* q, void* msg, uint32_t timeout);
+
+/**
+ * @brief      Zero copy send, reserve the next slot, sleeping while the
+ *             queue is full. Fill the slot in place, then msgq_commit it.
+ *
+ * @param      q        The queue to act on.
+ * @param      timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no
+ *                      limit.
+ *
+ * @return     Pointer to the slot, NULL on timeout.
+ */
+void* msgq_reserve(msgq_t* q, uint32_t timeout);
+
+/**
+ * @brief      Zero copy send, hand a filled slot over to the receivers.
+ *
+ * @param      q     The queue to act on.
+ * @param      slot  Slot returned by msgq_reserve.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int msgq_commit(msgq_t* q, void* slot);
+
+/**
+ * @brief      Zero copy receive, take the oldest message, sleeping while the
+ *             queue is empty. Read the slot in place, then msgq_release it.
+ *
+ * @param      q        The queue to act on.
+ * @param      timeout  Ticks to wait for, 0 to poll, WAIT_FOREVER for no
+ *                      limit.
+ *
+ * @return     Pointer to the slot, NULL on timeout.
+ */
+void* msgq_acquire(msgq_t* q, uint32_t timeout);
+
+/**
+ * @brief      Zero copy receive, give a slot back to the senders.
+ *
+ * @param      q     The queue to act on.
+ * @param      slot  Slot returned by msgq_acquire.
+ *
+ * @return     0 on success or -1 on failure
+ */
+int msgq_release(msgq_t* q, void* slot);
+
 /**
  * @brief      Runs expr, and if it has a non-zero return value, abort program.
  *             Prints information before aborting.
@@ -0,0 +1,323 @@
+/** @file   bench_kernel/main.c
+ *
+ *  @brief  user-space project "bench_kernel", measures the cost of kernel
+ *          primitives in core cycles
+ *
+ *  Every benchmark takes BENCH_SAMPLES samples with get_cycles() and prints
+ *  one line per benchmark once all of them ran:
+ *
+ *      BENCH,<mpu mode>,<name>,<samples>,<min>,<median>,<max>
+ *
+ *  so grep '^BENCH,' on the RTT output gives a CSV. The mpu mode is
+ *  per_thread or kernel_only, selected with USER_ARG="-p 1" or "-p 0".
+ *  Other output lines (the printf benchmark) never start with "BENCH,".
+ *
+ *  Samples are cycles between two get_cycles() calls minus the cost of an
+ *  empty pair (the svc_get_cycles minimum), so svc_* is one full syscall
+ *  round trip and the rest include the SVC entry and exit of their call.
+ *  Tick interrupts and budget expiry land in some samples, use the median.
+ *
+ *  @threads:   waiter:(1, 5), only created for the wait_period benchmark
+ *              partner:(100, 1000), the other end of switches and mutexes
+ *              bench:(500, 1000), runs the benchmarks and prints results
+ *
+ *  @output     BENCH lines as above, then exits
+**/
+
+#include <lib642.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define USR_STACK_WORDS 256
+#define NUM_THREADS 3
+#define NUM_MUTEXES 1
+#define CLOCK_FREQUENCY 1000
+
+/** @brief samples taken of every benchmark */
+#define BENCH_SAMPLES 64
+/** @brief most benchmarks in one run */
+#define MAX_BENCHES 20
+
+#define WAITER_PRIO 0
+#define PARTNER_PRIO 1
+#define BENCH_PRIO 2
+
+/** @brief what the partner thread does when woken */
+enum { CMD_SWITCH, CMD_MUTEX };
+
+typedef struct {
+	const char* name;
+	uint32_t samples[BENCH_SAMPLES];
+} bench_t;
+
+static bench_t benches[MAX_BENCHES];
+static int num_benches = 0;
+
+/** @brief cost of an empty pair of get_cycles() calls */
+static uint32_t overhead = 0;
+
+/** @brief partner thread state, written by both threads */
+static volatile int partner_cmd;
+static volatile uint32_t partner_t0;
+static volatile uint32_t partner_t1;
+static sem_t* partner_go;
+static mutex_t* mutex;
+
+/** @brief wait_until_next_period benchmark state, waiter to bench thread */
+static volatile int wait_flag = 0;
+static volatile uint32_t wait_t0;
+
+static const char* mode_name;
+
+/** @brief Cycles from t0 to t1 without the cost of reading the counter
+ */
+static uint32_t elapsed(uint32_t t0, uint32_t t1) {
+	uint32_t cycles = t1 - t0;
+	return (cycles > overhead) ? cycles - overhead : 0;
+}
+
+/** @brief Start a new benchmark, exits if there are too many
+ */
+static bench_t* bench_new(const char* name) {
+	if(num_benches == MAX_BENCHES) {
+		printf("Too many benchmarks, raise MAX_BENCHES\n");
+		exit(-1);
+	}
+	bench_t* b = &benches[num_benches++];
+	b->name = name;
+	return b;
+}
+
+/** @brief Time stmt BENCH_SAMPLES times as benchmark name
+ */
+#define BENCH_RUN(name, stmt) do { \
+	bench_t* b_ = bench_new(name); \
+	for(int i_ = 0; i_ < BENCH_SAMPLES; i_++) { \
+		uint32_t t0_ = get_cycles(); \
+		stmt; \
+		uint32_t t1_ = get_cycles(); \
+		b_->samples[i_] = elapsed(t0_, t1_); \
+	} \
+} while(0)
+
+/** @brief Sort a benchmark's samples and print its BENCH line
+ */
+static void bench_report(bench_t* b) {
+	uint32_t* s = b->samples;
+
+	// insertion sort, the samples are mostly equal already
+	for(int i = 1; i < BENCH_SAMPLES; i++) {
+		uint32_t v = s[i];
+		int j = i;
+		while((j > 0) && (s[j - 1] > v)) {
+			s[j] = s[j - 1];
+			j--;
+		}
+		s[j] = v;
+	}
+
+	printf("BENCH,%s,%s,%d,%lu,%lu,%lu\n", mode_name, b->name, BENCH_SAMPLES,
+		(unsigned long)s[0], (unsigned long)s[BENCH_SAMPLES / 2],
+		(unsigned long)s[BENCH_SAMPLES - 1]);
+}
+
+/** @brief Highest priority, time a wait_until_next_period which switches to
+ *         the bench thread, see bench_wait_period()
+ */
+void waiter_thread(UNUSED void* vargp) {
+	for(int i = 0; i < BENCH_SAMPLES; i++) {
+		wait_flag = 1;
+		wait_t0 = get_cycles();
+		wait_until_next_period();
+	}
+}
+
+/** @brief Woken by the bench thread through partner_go, stamps partner_t0
+ *         when it gets to run and partner_t1 once it holds the mutex
+ */
+void partner_thread(UNUSED void* vargp) {
+	while(1) {
+		sem_wait(partner_go, WAIT_FOREVER);
+		partner_t0 = get_cycles();
+
+		if(partner_cmd == CMD_MUTEX) {
+			mutex_lock(mutex);
+			partner_t1 = get_cycles();
+			mutex_unlock(mutex);
+		}
+	}
+}
+
+/** @brief Syscall round trips, the svc_get_cycles minimum also calibrates
+ *         the overhead taken off every other sample
+ */
+static void bench_svc() {
+	BENCH_RUN("svc_get_cycles", );
+
+	bench_t* calib = &benches[num_benches - 1];
+	uint32_t min = calib->samples[0];
+	for(int i = 1; i < BENCH_SAMPLES; i++) {
+		if(calib->samples[i] < min) min = calib->samples[i];
+	}
+	overhead = min;
+
+	BENCH_RUN("svc_get_time", get_time());
+	BENCH_RUN("svc_get_priority", get_priority());
+	BENCH_RUN("svc_thread_time", thread_time());
+	BENCH_RUN("svc_getpid", getpid());
+}
+
+/** @brief Semaphore and mutex calls which neither block nor wake anyone
+ */
+static void bench_uncontended() {
+	sem_t* sem = sem_init(0, BENCH_SAMPLES);
+	if(sem == NULL) {
+		printf("Failed to create semaphore\n");
+		exit(-1);
+	}
+	BENCH_RUN("sem_post", sem_post(sem));
+	BENCH_RUN("sem_wait", sem_wait(sem, WAIT_FOREVER));
+
+	bench_t* lock = bench_new("mutex_lock");
+	bench_t* unlock = bench_new("mutex_unlock");
+	for(int i = 0; i < BENCH_SAMPLES; i++) {
+		uint32_t t0 = get_cycles();
+		mutex_lock(mutex);
+		uint32_t t1 = get_cycles();
+		mutex_unlock(mutex);
+		uint32_t t2 = get_cycles();
+
+		lock->samples[i] = elapsed(t0, t1);
+		unlock->samples[i] = elapsed(t1, t2);
+	}
+}
+
+/** @brief Context switches through the partner thread's semaphore
+ *
+ *  switch_wake: sem_post waking the higher priority partner, through to the
+ *  partner running. switch_block: the partner's sem_wait blocking, through
+ *  to this thread running again.
+ */
+static void bench_switch() {
+	bench_t* wake = bench_new("switch_wake");
+	bench_t* block = bench_new("switch_block");
+
+	partner_cmd = CMD_SWITCH;
+	for(int i = 0; i < BENCH_SAMPLES; i++) {
+		uint32_t t0 = get_cycles();
+		sem_post(partner_go);
+		uint32_t t1 = get_cycles();
+
+		wake->samples[i] = elapsed(t0, partner_t0);
+		block->samples[i] = elapsed(partner_t0, t1);
+	}
+}
+
+/** @brief Contended mutex, this thread holds it while the partner locks it
+ *
+ *  mutex_lock_block: the partner's mutex_lock blocking, through to this
+ *  thread running again. mutex_unlock_handoff: mutex_unlock handing the
+ *  mutex to the partner, through to the partner running with it.
+ */
+static void bench_contended() {
+	bench_t* lock = bench_new("mutex_lock_block");
+	bench_t* unlock = bench_new("mutex_unlock_handoff");
+
+	partner_cmd = CMD_MUTEX;
+	for(int i = 0; i < BENCH_SAMPLES; i++) {
+		mutex_lock(mutex);
+		sem_post(partner_go);
+		uint32_t t0 = get_cycles();
+		mutex_unlock(mutex);
+
+		lock->samples[i] = elapsed(partner_t0, t0);
+		unlock->samples[i] = elapsed(t0, partner_t1);
+	}
+}
+
+/** @brief wait_until_next_period of the waiter thread, through to this
+ *         thread (the highest runnable one left) running again
+ */
+static void bench_wait_period() {
+	bench_t* wait = bench_new("wait_period");
+
+	ABORT_ON_ERROR(thread_create(&waiter_thread, WAITER_PRIO, 1, 5, NULL));
+
+	int i = 0;
+	while(i < BENCH_SAMPLES) {
+		if(wait_flag) {
+			uint32_t t1 = get_cycles();
+			wait->samples[i++] = elapsed(wait_t0, t1);
+			wait_flag = 0;
+		}
+	}
+}
+
+/** @brief printf of a typical status line, written out over RTT
+ */
+static void bench_printf() {
+	bench_t* b = bench_new("printf_line");
+
+	for(int i = 0; i < BENCH_SAMPLES; i++) {
+		uint32_t t0 = get_cycles();
+		printf("bench printf %d at tick %lu\n", i, (unsigned long)get_time());
+		b->samples[i] = elapsed(t0, get_cycles());
+	}
+}
+
+/** @brief Run every benchmark in order, print the results and exit
+ */
+void bench_thread(UNUSED void* vargp) {
+	bench_svc();
+	bench_uncontended();
+	bench_switch();
+	bench_contended();
+	bench_wait_period();
+	bench_printf();
+
+	for(int i = 0; i < num_benches; i++) {
+		bench_report(&benches[i]);
+	}
+	exit(0);
+}
+
+int main(int argc, char* const argv[]) {
+	int protection = PER_THREAD;
+	int opt;
+
+	while((opt = getopt(argc, argv, "p:")) != -1) {
+		switch(opt) {
+		case 'p':
+			protection = atoi(optarg);
+			break;
+
+		default:
+			abort();
+		}
+	}
+	mode_name = protection ? "per_thread" : "kernel_only";
+
+	ABORT_ON_ERROR(thread_init(NUM_THREADS, USR_STACK_WORDS, NULL, protection, NUM_MUTEXES));
+
+	mutex = mutex_init(PARTNER_PRIO);
+	if(mutex == NULL) {
+		printf("Failed to create mutex\n");
+		return -1;
+	}
+
+	partner_go = sem_init(0, 1);
+	if(partner_go == NULL) {
+		printf("Failed to create semaphore\n");
+		return -1;
+	}
+
+	ABORT_ON_ERROR(thread_create(&partner_thread, PARTNER_PRIO, 100, 1000, NULL));
+	ABORT_ON_ERROR(thread_create(&bench_thread, BENCH_PRIO, 500, 1000, NULL));
+
+	printf("Starting scheduler...\n");
+
+	ABORT_ON_ERROR(scheduler_start(CLOCK_FREQUENCY));
+
+	return 0;
+}
@@ -19,13 +19,20 @@
 #define NUM_MUTEXES 1
 #define CLOCK_FREQUENCY 1000
 
+/** @brief command event flags, one per thread acting on user_in */
+#define CMD_MOVE  (1 << 0)
+#define CMD_LEDS  (1 << 1)
+#define CMD_DANCE (1 << 2)
+
 char user_in[16];
 mutex_t* mutex_0;
+event_t* commands;
 
 /**
  * 
  * @brief This is the function that takes input from the user via RTT. Based on the commands given by the user
- * this function will take the necessary actions and execute those commands.
+ * this function will take the necessary actions and execute those commands. It runs as a sporadic server
+ * so it only uses its budget when keys were typed.
  * 
  * @params[in] unused void pointer
  * 
@@ -41,6 +48,7 @@ void user_input(UNUSED void* vargp) {
 
     while (1)
     {
+        server_wait();
         while ((cnt = read(0, input, 16)) > 0)
         {
             // printf("read the data = %s read bytes = %d\n", input, cnt);
@@ -64,6 +72,8 @@ void user_input(UNUSED void* vargp) {
                 // release lock here
                 di = 0;
                 mutex_unlock(mutex_0);
+                // wake the threads which act on the new command
+                event_set(commands, CMD_MOVE | CMD_LEDS | CMD_DANCE);
                 if (user_in[0] == 'e')
                 {
                     return;
@@ -77,8 +87,8 @@ void user_input(UNUSED void* vargp) {
 
 /**
  * 
- * @brief This thread is used to move the car based on the user input. It is schedule periodically
- * by the RMS scheduler and the car is moved accordingly.
+ * @brief This thread is used to move the car based on the user input. It sleeps until a new
+ * command arrives and the car is moved accordingly.
  * 
  * @params[in] none
  * 
@@ -89,6 +99,7 @@ void user_input(UNUSED void* vargp) {
 
 void move_car() {
     while(1){
+        event_wait(commands, CMD_MOVE, EVENT_WAIT_CLEAR, WAIT_FOREVER);
         if(user_in[0] == 'f') {
             forward();
             stop();
@@ -114,6 +125,7 @@ void move_car() {
             //stop spinning
             stop();
         }
+        wait_until_next_period();
     }
 }
 
@@ -146,7 +158,7 @@ void keep_printing() {
 
 /**
  * 
- * @brief This is a thread that runs periodically in order to be able to glow the 
+ * @brief This is a thread that runs on every new command in order to be able to glow the 
  * on board LEDs. The red and green LEDs are toggles based on the user input.
  * 
  * @params[in] none
@@ -157,6 +169,7 @@ void keep_printing() {
 
 void glow_onboard_leds() {
         while (1) {
+            event_wait(commands, CMD_LEDS, EVENT_WAIT_CLEAR, WAIT_FOREVER);
             if (user_in[0] == 'g') {
                 led_glow(1);
             }
@@ -187,6 +200,7 @@ void glow_onboard_leds() {
 
 void neo_dance() {
         while(1) {
+            event_wait(commands, CMD_DANCE, EVENT_WAIT_CLEAR, WAIT_FOREVER);
             if (user_in[0] == 'd') {
                 pix_set(1);
             }
@@ -242,8 +256,16 @@ int main(UNUSED int argc, UNUSED char* const argv[]) {
 		return -1;
 	}
 
+        commands = event_init();
+
+	if(commands == NULL) {
+		printf("Failed to create event group\n");
+		return -1;
+	}
+
 
-        ABORT_ON_ERROR(thread_create(&user_input, 2, 75, 500, NULL));
+        thread_attr_t input_attr = { .C = 75, .T = 500, .D = 0, .type = THREAD_TYPE_SERVER, .events = SERVER_EVENT_CONSOLE };
+        ABORT_ON_ERROR(thread_create_attr(&user_input, 2, &input_attr, NULL));
         //ABORT_ON_ERROR(thread_create(&keep_printing, 3, 50, 500, NULL));
         // ABORT_ON_ERROR(thread_create(&glow_onboard_leds, 1, 20, 250, NULL));
         // ABORT_ON_ERROR(thread_create(&neo_dance, 0, 100, 500, NULL));
@@ -253,7 +275,7 @@ int main(UNUSED int argc, UNUSED char* const argv[]) {
         
         printf("Type the following instructions to see the working:\n 1. 'dance' to start dance party\n 2. 'glow' to light up leds\n 3. 'pause' to pause the running function \n 4. 'forward' to move car forward \n 5. 'back' to move car backward \n 6. 'left' to move car to left \n 7. 'right' to move car to right \n 8. 'exit' to exit application\n");
         
-	ABORT_ON_ERROR(scheduler_start(CLOCK_FREQUENCY), "Threads are unschedulable!\n");
+	ABORT_ON_ERROR(scheduler_start_mode(CLOCK_FREQUENCY, SCHED_MODE_TICKLESS), "Threads are unschedulable!\n");
 
 	return 0;
 }
\ No newline at end of file
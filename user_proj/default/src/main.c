@@ -19,8 +19,14 @@
 #define NUM_MUTEXES 1
 #define CLOCK_FREQUENCY 1000
 
+/** @brief command event flags, one per thread acting on user_in */
+#define CMD_MOVE  (1 << 0)
+#define CMD_LEDS  (1 << 1)
+#define CMD_DANCE (1 << 2)
+
 char user_in[16];
 mutex_t* mutex_0;
+event_t* commands;
 
 /**
  * 
@@ -58,6 +64,8 @@ void user_input(UNUSED void* vargp) {
                                 // release lock here
                                 di = 0;
                                 mutex_unlock(mutex_0);
+                                // wake the threads which act on the new command
+                                event_set(commands, CMD_MOVE | CMD_LEDS | CMD_DANCE);
                                 if (user_in[0] == 'e') {
                                     return;
                                 }
@@ -69,8 +77,8 @@ void user_input(UNUSED void* vargp) {
 
 /**
  * 
- * @brief This thread is used to move the car based on the user input. It is schedule periodically
- * by the RMS scheduler and the car is moved accordingly.
+ * @brief This thread is used to move the car based on the user input. It sleeps until a new
+ * command arrives and the car is moved accordingly.
  * 
  * @params[in] none
  * 
@@ -81,6 +89,7 @@ void user_input(UNUSED void* vargp) {
 
 void move_car() {
     while(1){
+        event_wait(commands, CMD_MOVE, EVENT_WAIT_CLEAR, WAIT_FOREVER);
         if(user_in[0] == 'f') {
             forward();
             stop();
@@ -106,6 +115,7 @@ void move_car() {
             //stop spinning
             stop();
         }
+        wait_until_next_period();
     }
 }
 
@@ -138,7 +148,7 @@ void keep_printing() {
 
 /**
  * 
- * @brief This is a thread that runs periodically in order to be able to glow the 
+ * @brief This is a thread that runs on every new command in order to be able to glow the 
  * on board LEDs. The red and green LEDs are toggles based on the user input.
  * 
  * @params[in] none
@@ -149,6 +159,7 @@ void keep_printing() {
 
 void glow_onboard_leds() {
         while (1) {
+            event_wait(commands, CMD_LEDS, EVENT_WAIT_CLEAR, WAIT_FOREVER);
             if (user_in[0] == 'g') {
                 led_glow(1);
             }
@@ -179,6 +190,7 @@ void glow_onboard_leds() {
 
 void neo_dance() {
         while(1) {
+            event_wait(commands, CMD_DANCE, EVENT_WAIT_CLEAR, WAIT_FOREVER);
             if (user_in[0] == 'd') {
                 pix_set(1);
             }
@@ -234,6 +246,13 @@ int main(UNUSED int argc, UNUSED char* const argv[]) {
 		return -1;
 	}
 
+        commands = event_init();
+
+	if(commands == NULL) {
+		printf("Failed to create event group\n");
+		return -1;
+	}
+
 
         ABORT_ON_ERROR(thread_create(&user_input, 2, 75, 500, NULL));
         //ABORT_ON_ERROR(thread_create(&keep_printing, 3, 50, 500, NULL));
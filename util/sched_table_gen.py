@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Build a schedule table for SCHED_MODE_TABLE from a periodic task set.
+
+The task set is one task per line, in thread creation order, in ticks:
+
+    C T [D]
+
+as in the simulator's task sets (sim/tasksets), other fields are ignored.
+The minor frame f is the largest one which divides the hyperperiod, fits
+every C and lets every job finish inside a whole frame after its release
+(2f - gcd(f, T) <= D). Jobs are then given to frames earliest deadline
+first. Without preemption inside a frame this is a heuristic, if it finds
+no table a smaller frame may still work, see --frame.
+
+    python3 util/sched_table_gen.py tasks.txt > sched_table.h
+
+writes a sched_table_t initializer for the user program, --sim writes the
+"minor" and "frame" lines the simulator reads instead.
+"""
+
+import argparse
+import math
+import sys
+
+MAX_FRAMES = 64  # SCHED_TABLE_MAX_FRAMES
+FRAME_SLOTS = 4  # SCHED_TABLE_FRAME_SLOTS
+
+
+def parse(path):
+    tasks = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            fields = line.split("#")[0].split()
+            if not fields or fields[0] in ("hz", "minor", "frame"):
+                continue
+            try:
+                C, T = int(fields[0]), int(fields[1])
+                D = T
+                if len(fields) > 2 and fields[2].isdigit():
+                    D = int(fields[2])
+                for field in fields[2:]:
+                    if field.startswith("D="):
+                        D = int(field[2:])
+            except (ValueError, IndexError):
+                sys.exit("%s:%d: expected C T [D]" % (path, lineno))
+            if not 0 < C <= D <= T:
+                sys.exit("%s:%d: need 0 < C <= D <= T" % (path, lineno))
+            tasks.append((C, T, D))
+    if not tasks:
+        sys.exit("%s: no tasks" % path)
+    return tasks
+
+
+def frame_sizes(tasks, hyperperiod):
+    """Minor frame sizes which satisfy the frame constraints, largest first."""
+    sizes = []
+    for n in range(1, MAX_FRAMES + 1):
+        f = hyperperiod // n
+        if hyperperiod % n:
+            continue
+        if f < max(C for C, _, _ in tasks):
+            continue
+        if all(2 * f - math.gcd(f, T) <= D for _, T, D in tasks):
+            sizes.append(f)
+    return sizes
+
+
+def build(tasks, hyperperiod, f):
+    """Slots of every minor frame, None if some job does not fit."""
+    jobs = []  # [release, deadline, tid, C]
+    for tid, (C, T, D) in enumerate(tasks, 1):
+        for release in range(0, hyperperiod, T):
+            jobs.append([release, release + D, tid, C])
+
+    frames = []
+    for start in range(0, hyperperiod, f):
+        end = start + f
+        ready = sorted((j for j in jobs if j[0] <= start), key=lambda j: j[1])
+        slots, used = [], 0
+        for job in ready:
+            if job[1] < end:
+                return None  # its last frame has passed
+            if len(slots) < FRAME_SLOTS and used + job[3] <= f and job[2] not in slots:
+                slots.append(job[2])
+                used += job[3]
+                jobs.remove(job)
+        frames.append(slots)
+    return frames if not jobs else None
+
+
+def c_table(frames, f, source):
+    lines = ["/* generated by util/sched_table_gen.py from %s, do not edit */" % source,
+             "static sched_table_t sched_table = {",
+             "    .minor_ticks = %d," % f,
+             "    .num_frames = %d," % len(frames),
+             "    .slots = {"]
+    for i, slots in enumerate(frames):
+        lines.append("        { %s }, /* %d */" % (", ".join(str(s) for s in slots) or "0", i * f))
+    lines += ["    },", "};"]
+    return "\n".join(lines)
+
+
+def sim_table(frames, f, source):
+    lines = ["# generated by util/sched_table_gen.py from %s" % source, "minor %d" % f]
+    lines += ["frame %s" % " ".join(str(s) for s in slots) for slots in frames]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("taskset", help="C T [D] per line, in creation order")
+    parser.add_argument("--frame", type=int, help="minor frame in ticks instead of the largest which works")
+    parser.add_argument("--sim", action="store_true", help="write simulator table lines")
+    args = parser.parse_args()
+
+    tasks = parse(args.taskset)
+    hyperperiod = 1
+    for _, T, _ in tasks:
+        hyperperiod = hyperperiod * T // math.gcd(hyperperiod, T)
+
+    sizes = [args.frame] if args.frame else frame_sizes(tasks, hyperperiod)
+    if not sizes:
+        sys.exit("no minor frame fits the hyperperiod of %d ticks in %d frames" % (hyperperiod, MAX_FRAMES))
+
+    for f in sizes:
+        if hyperperiod % f or hyperperiod // f > MAX_FRAMES:
+            sys.exit("the minor frame must divide the hyperperiod of %d ticks into at most %d frames" % (hyperperiod, MAX_FRAMES))
+        frames = build(tasks, hyperperiod, f)
+        if frames is not None:
+            print((sim_table if args.sim else c_table)(frames, f, args.taskset))
+            return
+
+    sys.exit("no table found, try splitting the longest tasks")
+
+
+if __name__ == "__main__":
+    main()
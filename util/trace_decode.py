@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Convert a capture of the kernel's RTT trace channel to a Chrome trace.
+
+Build with `make TRACE=1` and save RTT up channel 1 ("Trace") to a file,
+for example with `JLinkRTTLogger -RTTChannel 1` or OpenOCD's
+`rtt server start <port> 1`. Then
+
+    python3 util/trace_decode.py trace.bin -o trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+
+Every thread gets a track of the slices it ran and a track of its
+syscalls, exception handlers share one track. Releases, blocks, unblocks
+and mutex operations are instant events on the thread's track. The record
+layout and types mirror kernel/include/trace.h.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+RECORD = struct.Struct("<IBBH")
+
+TRACE_SWITCH = 1
+TRACE_RELEASE = 2
+TRACE_BLOCK = 3
+TRACE_UNBLOCK = 4
+TRACE_MUTEX_LOCK = 5
+TRACE_MUTEX_UNLOCK = 6
+TRACE_SVC_ENTER = 7
+TRACE_SVC_EXIT = 8
+TRACE_ISR_ENTER = 9
+TRACE_ISR_EXIT = 10
+TRACE_DROPPED = 11
+
+STATES = {0: "stopped", 1: "waiting", 2: "runnable", 3: "running", 4: "blocked", 5: "sleeping"}
+
+# exception numbers, IRQs are 16 + the nRF52840 peripheral id
+EXCEPTIONS = {11: "SVCall", 14: "PendSV", 15: "SysTick", 22: "GPIOTE", 23: "SAADC", 25: "TIMER1"}
+
+PID = 1
+ISR_TRACK = 1000
+SVC_TRACK = 2000
+
+
+def svc_names():
+    """Syscall names from svc_num.h, by number."""
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "kernel", "include", "svc_num.h")
+    names = {}
+    try:
+        with open(path) as f:
+            for name, num in re.findall(r"#define\s+(\w+)\s+(\d+)", f.read()):
+                names.setdefault(int(num), name[4:].lower() if name.startswith("SVC_") else name.lower())
+    except OSError:
+        pass
+    return names
+
+
+def records(data):
+    """Yields (time in cycles, type, tid, arg), the 32 bit cycle count unwrapped."""
+    last = None
+    now = 0
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        cycles, kind, tid, arg = RECORD.unpack_from(data, offset)
+        if last is not None:
+            now += (cycles - last) & 0xFFFFFFFF
+        last = cycles
+        yield now, kind, tid, arg
+
+
+def thread_name(tid, idle_tid):
+    if tid == 0:
+        return "main"
+    if tid == idle_tid:
+        return "idle"
+    return "thread %d" % tid
+
+
+def decode(data, cpu_hz, idle_tid):
+    us = 1e6 / cpu_hz
+    svcs = svc_names()
+    events = []
+    tids = set()
+
+    running = None      # (tid, start) of the slice being run
+    svc_open = {}       # tid -> (svc number, start)
+    isr_open = []       # stack of (exception number, start)
+    end = 0
+
+    def complete(name, tid, start, stop, cat):
+        events.append({"name": name, "cat": cat, "ph": "X", "pid": PID, "tid": tid,
+                       "ts": start * us, "dur": (stop - start) * us})
+
+    def instant(name, tid, t, args=None):
+        event = {"name": name, "ph": "i", "s": "t", "pid": PID, "tid": tid, "ts": t * us}
+        if args:
+            event["args"] = args
+        events.append(event)
+
+    for t, kind, tid, arg in records(data):
+        end = t
+        tids.add(tid)
+
+        if kind == TRACE_SWITCH:
+            if running is not None:
+                complete("run", running[0], running[1], t, "sched")
+            running = (tid, t)
+        elif kind == TRACE_RELEASE:
+            instant("release", tid, t)
+        elif kind == TRACE_BLOCK:
+            instant(STATES.get(arg, "state %d" % arg), tid, t)
+        elif kind == TRACE_UNBLOCK:
+            instant("unblock", tid, t)
+        elif kind == TRACE_MUTEX_LOCK:
+            instant("lock", tid, t, {"mutex": arg})
+        elif kind == TRACE_MUTEX_UNLOCK:
+            instant("unlock", tid, t, {"mutex": arg})
+        elif kind == TRACE_SVC_ENTER:
+            svc_open[tid] = (arg, t)
+        elif kind == TRACE_SVC_EXIT:
+            if tid in svc_open:
+                num, start = svc_open.pop(tid)
+                complete(svcs.get(num, "svc %d" % num), SVC_TRACK + tid, start, t, "svc")
+        elif kind == TRACE_ISR_ENTER:
+            isr_open.append((arg, t))
+        elif kind == TRACE_ISR_EXIT:
+            # records dropped in between may leave unmatched entries below
+            while isr_open:
+                num, start = isr_open.pop()
+                if num == arg:
+                    complete(EXCEPTIONS.get(num, "exception %d" % num), ISR_TRACK, start, t, "isr")
+                    break
+        elif kind == TRACE_DROPPED:
+            events.append({"name": "dropped %d records" % arg, "ph": "i", "s": "g",
+                           "pid": PID, "tid": ISR_TRACK, "ts": t * us})
+        else:
+            print("unknown record type %d, is the capture aligned?" % kind, file=sys.stderr)
+
+    if running is not None:
+        complete("run", running[0], running[1], end, "sched")
+
+    meta = [{"name": "process_name", "ph": "M", "pid": PID, "args": {"name": "kernel"}},
+            {"name": "thread_name", "ph": "M", "pid": PID, "tid": ISR_TRACK, "args": {"name": "exceptions"}}]
+    for tid in sorted(tids):
+        name = thread_name(tid, idle_tid)
+        meta.append({"name": "thread_name", "ph": "M", "pid": PID, "tid": tid, "args": {"name": name}})
+        meta.append({"name": "thread_name", "ph": "M", "pid": PID, "tid": SVC_TRACK + tid,
+                     "args": {"name": name + " syscalls"}})
+        meta.append({"name": "thread_sort_index", "ph": "M", "pid": PID, "tid": SVC_TRACK + tid,
+                     "args": {"sort_index": tid}})
+
+    return {"traceEvents": meta + events, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", help="raw bytes of RTT up channel 1")
+    parser.add_argument("-o", "--output", help="Chrome trace JSON, stdout if not given")
+    parser.add_argument("--cpu-hz", type=float, default=64e6, help="core clock, default 64 MHz")
+    parser.add_argument("--idle-tid", type=int, default=15, help="idle thread id, MAX_THREADS + 1")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        data = f.read()
+    if len(data) % RECORD.size:
+        print("capture is not a whole number of records, the tail is ignored", file=sys.stderr)
+
+    trace = decode(data, args.cpu_hz, args.idle_tid)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()